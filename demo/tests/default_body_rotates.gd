@@ -0,0 +1,24 @@
+extends Node2D
+
+# Checks that a RigidBody2D with the default mass properties gets its inertia from its shapes and rotates.
+# Run with: godot --headless --path demo res://tests/default_body_rotates.tscn
+# Exits with code 1 if the body didn't rotate.
+
+const TORQUE_FRAMES = 10
+
+var frame := 0
+
+
+func _physics_process(_delta: float) -> void:
+	frame += 1
+	var box: RigidBody2D = $Box
+	if frame <= TORQUE_FRAMES:
+		box.apply_torque(10000.0)
+		return
+	var inertia: float = PhysicsServer2D.body_get_direct_state(box.get_rid()).inverse_inertia
+	if absf(box.angular_velocity) > 0.0 and inertia > 0.0:
+		print("Default body rotates, angular velocity %f." % box.angular_velocity)
+		get_tree().quit(0)
+	else:
+		printerr("Default body didn't rotate, angular velocity %f, inverse inertia %f." % [box.angular_velocity, inertia])
+		get_tree().quit(1)
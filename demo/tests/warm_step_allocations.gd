@@ -0,0 +1,27 @@
+extends Node2D
+
+# Checks that a step makes no Box2D allocations once the scene has settled.
+# Run with: godot --headless --path demo res://tests/warm_step_allocations.tscn
+# Exits with code 1 if any checked step allocated.
+
+const WARM_UP_FRAMES = 300
+const CHECKED_FRAMES = 120
+
+var frame := 0
+var failed_steps := 0
+
+
+func _physics_process(_delta: float) -> void:
+	frame += 1
+	if frame <= WARM_UP_FRAMES:
+		return
+	# reports the step of the previous frame
+	var statistics: Dictionary = PhysicsServer2D.call("get_space_memory_statistics", get_world_2d().space)
+	var allocs: int = statistics["last_step_alloc_count"]
+	if allocs != 0:
+		failed_steps += 1
+		printerr("Frame %d: warm step allocated %d times in Box2D." % [frame, allocs])
+	if frame == WARM_UP_FRAMES + CHECKED_FRAMES:
+		if failed_steps == 0:
+			print("Warm steps made no Box2D allocations.")
+		get_tree().quit(1 if failed_steps > 0 else 0)
@@ -3,8 +3,6 @@
 #include <stdarg.h>
 #include <stdint.h>
 
-#include <godot_cpp/core/memory.hpp>
-
 // Tunable Constants
 
 /// You can use this to change the length scale used by your game.
@@ -47,14 +45,17 @@ struct B2_API b2JointUserData {
 	uintptr_t pointer;
 };
 
-// Memory Allocation using Godot's functions
+// Memory Allocation through the allocator of the space being worked on, see Box2DSpaceAllocator
+
+void *box2d_alloc(int32_t p_size);
+void box2d_free(void *p_mem);
 
 inline void *b2Alloc(int32 size) {
-	return memalloc(size);
+	return box2d_alloc(size);
 }
 
 inline void b2Free(void *mem) {
-	memfree(mem);
+	box2d_free(mem);
 }
 
 /// Default logging function
@@ -18,18 +18,15 @@ void Box2DArea::set_area_monitor_callback(const Callable &p_callback) {
 	area_monitor_callback = p_callback;
 }
 void Box2DArea::call_area_monitor(Box2DArea *area, PhysicsServer2D::AreaBodyStatus status, const RID &p_area, ObjectID p_instance, int area_shape_idx, int self_shape_idx) {
-	if (get_monitoring() && area->monitorable) {
-		area_monitor_callback.callv(Array::make(status, p_area, p_instance, area_shape_idx, self_shape_idx));
+	// area is null when it was removed from the space before the event got reported
+	if (get_monitoring() && (!area || area->monitorable)) {
+		area_monitor_callback.call(status, p_area, p_instance, area_shape_idx, self_shape_idx);
 	}
 }
 void Box2DArea::call_monitor(Box2DCollisionObject *body, PhysicsServer2D::AreaBodyStatus status, const RID &p_body, ObjectID p_instance, int32_t area_shape_idx, int32_t self_shape_idx) {
 	if (monitor_callback.is_valid()) {
-		monitor_callback.callv(Array::make(status, p_body, p_instance, area_shape_idx, self_shape_idx));
-		if (status == PhysicsServer2D::AreaBodyStatus::AREA_BODY_ADDED) {
-			add_body(body);
-		} else {
-			remove_body(body);
-		}
+		// the space already applied the membership change, see Box2DSpace::apply_area_memberships
+		monitor_callback.call(status, p_body, p_instance, area_shape_idx, self_shape_idx);
 	}
 }
 
@@ -54,11 +51,8 @@ void Box2DArea::set_priority(real_t p_priority) {
 		return;
 	}
 	collision.priority = p_priority;
-	for (Box2DCollisionObject *body : bodies) {
-		body->sort_areas();
-		body->recalculate_total_gravity();
-		body->recalculate_total_angular_damp();
-		body->recalculate_total_linear_damp();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->area_priority_changed(membership);
 	}
 }
 
@@ -67,8 +61,8 @@ void Box2DArea::set_gravity_override_mode(PhysicsServer2D::AreaSpaceOverrideMode
 		return;
 	}
 	gravity.override_mode = p_value;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_gravity();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_gravity();
 	}
 }
 void Box2DArea::set_gravity(real_t p_value) {
@@ -76,8 +70,8 @@ void Box2DArea::set_gravity(real_t p_value) {
 		return;
 	}
 	gravity.gravity = godot_to_box2d(p_value);
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_gravity();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_gravity();
 	}
 }
 void Box2DArea::set_gravity_vector(Vector2 p_value) {
@@ -85,8 +79,8 @@ void Box2DArea::set_gravity_vector(Vector2 p_value) {
 		return;
 	}
 	gravity.vector = b2Vec2(p_value.x, p_value.y);
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_gravity();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_gravity();
 	}
 }
 void Box2DArea::set_gravity_is_point(bool p_value) {
@@ -94,8 +88,8 @@ void Box2DArea::set_gravity_is_point(bool p_value) {
 		return;
 	}
 	gravity.is_point = p_value;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_gravity();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_gravity();
 	}
 }
 void Box2DArea::set_gravity_point_unit_distance(double p_value) {
@@ -103,8 +97,8 @@ void Box2DArea::set_gravity_point_unit_distance(double p_value) {
 		return;
 	}
 	gravity.point_unit_distance = p_value;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_gravity();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_gravity();
 	}
 }
 void Box2DArea::set_linear_damp_override_mode(PhysicsServer2D::AreaSpaceOverrideMode p_value) {
@@ -112,8 +106,8 @@ void Box2DArea::set_linear_damp_override_mode(PhysicsServer2D::AreaSpaceOverride
 		return;
 	}
 	linear_damp_override_mode = p_value;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_linear_damp();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_linear_damp();
 	}
 }
 void Box2DArea::set_angular_damp_override_mode(PhysicsServer2D::AreaSpaceOverrideMode p_value) {
@@ -121,8 +115,8 @@ void Box2DArea::set_angular_damp_override_mode(PhysicsServer2D::AreaSpaceOverrid
 		return;
 	}
 	angular_damp_override_mode = p_value;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_angular_damp();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_angular_damp();
 	}
 }
 
@@ -131,8 +125,8 @@ void Box2DArea::set_linear_damp(real_t p_linear_damp) {
 		return;
 	}
 	damping.linear_damp = p_linear_damp;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_linear_damp();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_linear_damp();
 	}
 }
 void Box2DArea::set_angular_damp(real_t p_angular_damp) {
@@ -140,8 +134,8 @@ void Box2DArea::set_angular_damp(real_t p_angular_damp) {
 		return;
 	}
 	damping.angular_damp = p_angular_damp;
-	for (Box2DCollisionObject *body : bodies) {
-		body->recalculate_total_angular_damp();
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->recalculate_total_angular_damp();
 	}
 }
 
@@ -182,12 +176,43 @@ PhysicsServer2D::AreaSpaceOverrideMode Box2DArea::get_angular_damp_override_mode
 	return angular_damp_override_mode;
 }
 void Box2DArea::add_body(Box2DCollisionObject *p_body) {
-	bodies.append(p_body);
-	p_body->add_area(this);
+	Box2DAreaMembership *membership = p_body->find_area_membership(this);
+	if (membership) {
+		membership->overlap_count++;
+		return;
+	}
+	membership = memnew(Box2DAreaMembership);
+	membership->area = this;
+	membership->object = p_body;
+	membership->area_index = bodies.size();
+	membership->overlap_count = 1;
+	bodies.push_back(membership);
+	p_body->add_area(membership);
 }
 void Box2DArea::remove_body(Box2DCollisionObject *p_body) {
-	bodies.erase(p_body);
-	p_body->remove_area(this);
+	Box2DAreaMembership *membership = p_body->find_area_membership(this);
+	if (!membership) {
+		return;
+	}
+	membership->overlap_count--;
+	if (membership->overlap_count > 0) {
+		return;
+	}
+	p_body->remove_area(membership);
+	drop_membership(membership);
+}
+void Box2DArea::drop_membership(Box2DAreaMembership *p_membership) {
+	uint32_t index = p_membership->area_index;
+	ERR_FAIL_COND(index >= bodies.size() || bodies[index] != p_membership);
+	// swap with the last one and fix its index
+	bodies[index] = bodies[bodies.size() - 1];
+	bodies[index]->area_index = index;
+	bodies.resize(bodies.size() - 1);
+	memdelete(p_membership);
+}
+
+int64_t Box2DArea::get_memory_footprint() const {
+	return Box2DCollisionObject::get_memory_footprint() + sizeof(Box2DArea) - sizeof(Box2DCollisionObject) + bodies.size() * (sizeof(Box2DAreaMembership *) + sizeof(Box2DAreaMembership));
 }
 
 Box2DArea::Box2DArea() :
@@ -198,14 +223,13 @@ Box2DArea::Box2DArea() :
 	// b2_staticBody don't collide with b2_staticBody or b2_kinematicBody
 	// b2_kinematicBody don't collide with b2_staticBody or b2_kinematicBody
 	// and areas have to be able to intersect with both kinematic and static bodies
-	body_def->type = b2_dynamicBody;
+	body_def.type = b2_dynamicBody;
 	//_set_static(true); //areas are not active by default
 }
 
 Box2DArea::~Box2DArea() {
-	for (Box2DCollisionObject *body : bodies) {
-		if (body) {
-			body->remove_area(this);
-		}
+	for (Box2DAreaMembership *membership : bodies) {
+		membership->object->remove_area(membership);
+		memdelete(membership);
 	}
 }
@@ -27,7 +27,7 @@ class Box2DArea : public Box2DCollisionObject {
 	Gravity gravity;
 	PhysicsServer2D::AreaSpaceOverrideMode linear_damp_override_mode = PhysicsServer2D::AreaSpaceOverrideMode::AREA_SPACE_OVERRIDE_DISABLED;
 	PhysicsServer2D::AreaSpaceOverrideMode angular_damp_override_mode = PhysicsServer2D::AreaSpaceOverrideMode::AREA_SPACE_OVERRIDE_DISABLED;
-	Vector<Box2DCollisionObject *> bodies;
+	LocalVector<Box2DAreaMembership *> bodies; // unordered
 
 	void update_bodies();
 
@@ -48,6 +48,8 @@ public:
 
 	virtual void set_space(Box2DSpace *p_space) override;
 
+	virtual int64_t get_memory_footprint() const override;
+
 	void set_gravity_override_mode(PhysicsServer2D::AreaSpaceOverrideMode p_value);
 	void set_gravity(real_t p_value);
 	void set_gravity_vector(Vector2 p_value);
@@ -67,6 +69,8 @@ public:
 
 	void add_body(Box2DCollisionObject *p_body);
 	void remove_body(Box2DCollisionObject *p_body);
+	// Removes the membership from this area only and frees it, for objects being destroyed.
+	void drop_membership(Box2DAreaMembership *p_membership);
 
 	Box2DArea();
 	~Box2DArea();
@@ -33,6 +33,12 @@ Box2DDirectBodyState *Box2DBody::get_direct_state() {
 	return direct_state;
 }
 
+void Box2DBody::_forces_changed() {
+	if (slot_index >= 0) {
+		get_space()->body_set_slot_forces(slot_index, gravity_scale, total_gravity, constant_forces.constant_force, constant_forces.constant_force_position, constant_forces.constant_torque);
+	}
+}
+
 void Box2DBody::set_active(bool p_active) {
 	if (active == p_active) {
 		return;
@@ -52,6 +58,9 @@ void Box2DBody::set_active(bool p_active) {
 		set_sleep_state(false);
 		get_space()->body_remove_from_active_list(&active_list);
 	}
+	if (slot_index >= 0) {
+		get_space()->body_set_slot_active(slot_index, active);
+	}
 }
 
 void Box2DBody::set_mode(PhysicsServer2D::BodyMode p_mode) {
@@ -62,33 +71,35 @@ void Box2DBody::set_mode(PhysicsServer2D::BodyMode p_mode) {
 	switch (p_mode) {
 		case PhysicsServer2D::BODY_MODE_STATIC: {
 			// TODO: other stuff
-			body_def->type = b2_staticBody;
-			body_def->fixedRotation = false;
+			body_def.type = b2_staticBody;
+			body_def.fixedRotation = false;
 			set_active(false);
 		} break;
 		case PhysicsServer2D::BODY_MODE_KINEMATIC: {
 			// TODO: other stuff
-			body_def->type = b2_kinematicBody;
-			body_def->fixedRotation = false;
+			body_def.type = b2_kinematicBody;
+			body_def.fixedRotation = false;
 			set_active(true); // TODO: consider contacts
 		} break;
 		case PhysicsServer2D::BODY_MODE_RIGID: {
-			body_def->type = b2_dynamicBody;
-			body_def->fixedRotation = false;
+			body_def.type = b2_dynamicBody;
+			body_def.fixedRotation = false;
 			set_active(true);
 		} break;
 		case PhysicsServer2D::BODY_MODE_RIGID_LINEAR: {
 			// TODO: (inverse) mass calculation?
 			//_set_static(false);
-			body_def->type = b2_dynamicBody;
-			body_def->fixedRotation = true;
+			body_def.type = b2_dynamicBody;
+			body_def.fixedRotation = true;
 			set_active(true);
 		} break;
 	}
 	if (body) {
-		body->SetType(body_def->type);
-		body->SetFixedRotation(body_def->fixedRotation);
-		body->SetMassData(&mass_data);
+		// destroys contacts and touches the broadphase
+		Box2DSpaceAllocator::Scope allocator_scope(get_space()->get_allocator());
+		body->SetType(body_def.type);
+		body->SetFixedRotation(body_def.fixedRotation);
+		_apply_mass_data();
 	}
 }
 
@@ -153,6 +164,9 @@ void Box2DBody::set_state(PhysicsServer2D::BodyState p_state, const Variant &p_v
 			}
 		} break;
 	}
+	if (slot_index >= 0) {
+		get_space()->body_update_snapshot(slot_index);
+	}
 }
 
 Variant Box2DBody::get_state(PhysicsServer2D::BodyState p_state) const {
@@ -176,6 +190,31 @@ Variant Box2DBody::get_state(PhysicsServer2D::BodyState p_state) const {
 	return Variant();
 }
 
+Variant Box2DBody::get_snapshot_state(PhysicsServer2D::BodyState p_state) const {
+	if (slot_index < 0) {
+		return get_state(p_state);
+	}
+	const Box2DSpace::BodySnapshot &snapshot = get_space()->get_body_snapshot(slot_index);
+	switch (p_state) {
+		case PhysicsServer2D::BODY_STATE_TRANSFORM: {
+			return snapshot.transform;
+		} break;
+		case PhysicsServer2D::BODY_STATE_LINEAR_VELOCITY: {
+			return snapshot.linear_velocity;
+		} break;
+		case PhysicsServer2D::BODY_STATE_ANGULAR_VELOCITY: {
+			return snapshot.angular_velocity;
+		} break;
+		case PhysicsServer2D::BODY_STATE_SLEEPING: {
+			return snapshot.sleeping;
+		}
+		case PhysicsServer2D::BODY_STATE_CAN_SLEEP: {
+			return can_sleep;
+		}
+	}
+	return Variant();
+}
+
 void Box2DBody::set_space(Box2DSpace *p_space) {
 	if (get_space()) {
 		// TODO: clean up more
@@ -185,6 +224,10 @@ void Box2DBody::set_space(Box2DSpace *p_space) {
 		if (direct_state_query_list.in_list()) {
 			get_space()->body_remove_from_state_query_list(&direct_state_query_list);
 		}
+		if (slot_index >= 0) {
+			get_space()->body_remove_slot(slot_index);
+			slot_index = -1;
+		}
 	}
 
 	_set_space(p_space);
@@ -197,6 +240,11 @@ void Box2DBody::set_space(Box2DSpace *p_space) {
 		if (active) {
 			get_space()->body_add_to_active_list(&active_list);
 		}
+		slot_index = get_space()->body_add_slot(this);
+		if (slot_index >= 0) {
+			get_space()->body_set_slot_active(slot_index, active);
+			_forces_changed();
+		}
 	}
 }
 
@@ -207,9 +255,9 @@ void Box2DBody::after_step() {
 }
 
 void Box2DBody::call_queries() {
-	Variant direct_state = get_direct_state();
 	if (body_state_callback.is_valid()) {
-		body_state_callback.callv(Array::make(direct_state));
+		// call() passes the arguments on the stack, callv() would build an Array every step
+		body_state_callback.call(get_direct_state());
 	}
 }
 
@@ -220,15 +268,15 @@ void Box2DBody::set_continuous_collision_detection_mode(PhysicsServer2D::CCDMode
 	collision_mode = p_mode;
 	switch (collision_mode) {
 		case PhysicsServer2D::CCD_MODE_DISABLED: {
-			body_def->bullet = false;
+			body_def.bullet = false;
 		} break;
 		case PhysicsServer2D::CCD_MODE_CAST_RAY:
 		case PhysicsServer2D::CCD_MODE_CAST_SHAPE:
-			body_def->bullet = true;
+			body_def.bullet = true;
 			break;
 	}
 	if (body) {
-		body->SetBullet(body_def->bullet);
+		body->SetBullet(body_def.bullet);
 	}
 }
 PhysicsServer2D::CCDMode Box2DBody::get_continuous_collision_detection_mode() const {
@@ -246,6 +294,17 @@ HashSet<Box2DJoint *> Box2DBody::get_joints() {
 	return joints;
 }
 
+int64_t Box2DBody::get_memory_footprint() const {
+	int64_t size = Box2DCollisionObject::get_memory_footprint() + sizeof(Box2DBody) - sizeof(Box2DCollisionObject);
+	if (!joints.is_empty()) {
+		size += joints.get_capacity() * (sizeof(Box2DJoint *) + 3 * sizeof(uint32_t));
+	}
+	if (direct_state) {
+		size += sizeof(Box2DDirectBodyState);
+	}
+	return size;
+}
+
 Box2DBody::Box2DBody() :
 		Box2DCollisionObject(TYPE_BODY),
 		active_list(this),
@@ -31,6 +31,10 @@ class Box2DBody : public Box2DCollisionObject {
 	Box2DDirectBodyState *direct_state = nullptr;
 	HashSet<Box2DJoint *> joints;
 	int32 max_contacts_reported = 0;
+	int32_t slot_index = -1; // slot in the space body arrays
+
+protected:
+	virtual void _forces_changed() override;
 
 public:
 	// Physics Server
@@ -54,6 +58,10 @@ public:
 
 	void set_state(PhysicsServer2D::BodyState p_state, const Variant &p_variant);
 	Variant get_state(PhysicsServer2D::BodyState p_state) const;
+	// Same as get_state, but reads the space snapshot of the last step, so it's safe while a step runs.
+	Variant get_snapshot_state(PhysicsServer2D::BodyState p_state) const;
+
+	_FORCE_INLINE_ void set_slot_index(int32_t p_index) { slot_index = p_index; }
 
 	void set_continuous_collision_detection_mode(PhysicsServer2D::CCDMode mode);
 	PhysicsServer2D::CCDMode get_continuous_collision_detection_mode() const;
@@ -63,6 +71,8 @@ public:
 
 	virtual HashSet<Box2DJoint *> get_joints() override;
 
+	virtual int64_t get_memory_footprint() const override;
+
 	void after_step();
 	void call_queries();
 
@@ -17,9 +17,8 @@ void Box2DCollisionObject::reset_mass_properties() {
 	mass_data.mass = 1;
 	mass_data.I = 0;
 	mass_data.center = b2Vec2();
-	if (body) {
-		body->SetMassData(&mass_data);
-	}
+	center_of_mass_set = false;
+	_apply_mass_data();
 }
 
 void Box2DCollisionObject::set_mass(real_t p_mass) {
@@ -27,9 +26,7 @@ void Box2DCollisionObject::set_mass(real_t p_mass) {
 		return;
 	}
 	mass_data.mass = p_mass;
-	if (body) {
-		body->SetMassData(&mass_data);
-	}
+	_apply_mass_data();
 }
 double Box2DCollisionObject::get_mass() const {
 	return mass_data.mass; // no need to convert
@@ -39,27 +36,52 @@ void Box2DCollisionObject::set_inertia(real_t p_inertia) {
 		return;
 	}
 	mass_data.I = p_inertia;
-	if (body) {
-		body->SetMassData(&mass_data);
-	}
+	_apply_mass_data();
 }
 double Box2DCollisionObject::get_inertia() const {
+	if (mass_data.I <= 0 && body && body->GetType() == b2_dynamicBody) {
+		// computed from the fixtures, b2Body keeps it about the origin
+		b2Vec2 center = body->GetLocalCenter();
+		return body->GetInertia() - body->GetMass() * b2Dot(center, center);
+	}
 	return mass_data.I; // no need to convert
 }
+void Box2DCollisionObject::_apply_mass_data() {
+	if (!body || body->GetType() != b2_dynamicBody) {
+		return;
+	}
+	// b2MassData wants the inertia about the body origin, Godot gives it about the center of mass
+	b2MassData applied = mass_data;
+	real_t inertia = mass_data.I;
+	if (mass_data.I <= 0 || !center_of_mass_set) {
+		// take what wasn't configured from the fixtures, scaled to the configured mass
+		body->ResetMassData();
+		b2MassData computed;
+		body->GetMassData(&computed);
+		if (!center_of_mass_set) {
+			applied.center = computed.center;
+		}
+		if (mass_data.I <= 0 && computed.mass > 0) {
+			inertia = (computed.I - computed.mass * b2Dot(computed.center, computed.center)) * mass_data.mass / computed.mass;
+		}
+	}
+	applied.I = inertia > 0 ? inertia + applied.mass * b2Dot(applied.center, applied.center) : 0;
+	body->SetMassData(&applied);
+}
 void Box2DCollisionObject::set_center_of_mass(Vector2 p_center_of_mass) {
-	if (godot_to_box2d(p_center_of_mass) == mass_data.center) {
+	if (center_of_mass_set && godot_to_box2d(p_center_of_mass) == mass_data.center) {
 		return;
 	}
 	godot_to_box2d(p_center_of_mass, mass_data.center);
-	if (body) {
-		body->SetMassData(&mass_data);
-	}
+	center_of_mass_set = true;
+	_apply_mass_data();
 }
 Vector2 Box2DCollisionObject::get_center_of_mass() const {
 	if (body) {
-		return box2d_to_godot(mass_data.center + body->GetPosition());
+		b2Vec2 center = center_of_mass_set ? mass_data.center : body->GetLocalCenter();
+		return box2d_to_godot(center + body->GetPosition());
 	} else {
-		return box2d_to_godot(mass_data.center + body_def->position);
+		return box2d_to_godot(mass_data.center + body_def.position);
 	}
 }
 
@@ -110,18 +132,19 @@ double Box2DCollisionObject::get_angular_damp() const {
 void Box2DCollisionObject::recalculate_total_linear_damp() {
 	total_linear_damp = damping.linear_damp;
 	if (get_linear_damp_mode() == PhysicsServer2D::BodyDampMode::BODY_DAMP_MODE_REPLACE) {
-		body_def->linearDamping = total_linear_damp;
+		body_def.linearDamping = total_linear_damp;
 		if (body) {
-			body->SetLinearDamping(body_def->linearDamping);
+			body->SetLinearDamping(body_def.linearDamping);
 		}
 		// replace linear damp with body one
 		return;
 	}
 	bool keep_computing = true;
-	for (Box2DArea *area : areas) {
+	for (Box2DAreaMembership *membership : areas) {
 		if (!keep_computing) {
 			break;
 		}
+		const Box2DArea *area = membership->area;
 		real_t linear_damp = area->damping.linear_damp;
 		switch (area->get_linear_damp_override_mode()) {
 			case PhysicsServer2D::AreaSpaceOverrideMode::AREA_SPACE_OVERRIDE_COMBINE: {
@@ -142,28 +165,29 @@ void Box2DCollisionObject::recalculate_total_linear_damp() {
 			}
 		}
 	}
-	body_def->linearDamping = total_linear_damp;
+	body_def.linearDamping = total_linear_damp;
 	if (body) {
-		body->SetLinearDamping(body_def->linearDamping);
+		body->SetLinearDamping(body_def.linearDamping);
 	}
 }
 
 void Box2DCollisionObject::recalculate_total_angular_damp() {
 	total_angular_damp = damping.angular_damp;
 	if (get_angular_damp_mode() == PhysicsServer2D::BodyDampMode::BODY_DAMP_MODE_REPLACE) {
-		body_def->angularDamping = total_angular_damp;
+		body_def.angularDamping = total_angular_damp;
 		if (body) {
-			body->SetAngularDamping(body_def->angularDamping);
+			body->SetAngularDamping(body_def.angularDamping);
 		}
 		// replace angular damp with body one
 		return;
 	}
 	// compute angular damp from areas
 	bool keep_computing = true;
-	for (Box2DArea *area : areas) {
+	for (Box2DAreaMembership *membership : areas) {
 		if (!keep_computing) {
 			break;
 		}
+		const Box2DArea *area = membership->area;
 		real_t angular_damp = area->damping.angular_damp;
 		switch (area->get_angular_damp_override_mode()) {
 			case PhysicsServer2D::AreaSpaceOverrideMode::AREA_SPACE_OVERRIDE_COMBINE: {
@@ -184,9 +208,9 @@ void Box2DCollisionObject::recalculate_total_angular_damp() {
 			}
 		}
 	}
-	body_def->angularDamping = total_angular_damp;
+	body_def.angularDamping = total_angular_damp;
 	if (body) {
-		body->SetAngularDamping(body_def->angularDamping);
+		body->SetAngularDamping(body_def.angularDamping);
 	}
 }
 
@@ -207,18 +231,14 @@ void Box2DCollisionObject::set_bounce(real_t p_bounce) {
 		return;
 	}
 	physics_material.bounce = p_bounce;
-	if (body) {
-		_update_shapes();
-	}
+	_queue_update(UPDATE_MATERIAL);
 }
 void Box2DCollisionObject::set_friction(real_t p_friction) {
 	if (physics_material.friction == p_friction) {
 		return;
 	}
 	physics_material.friction = p_friction;
-	if (body) {
-		_update_shapes();
-	}
+	_queue_update(UPDATE_MATERIAL);
 }
 
 double Box2DCollisionObject::get_bounce() const {
@@ -235,14 +255,17 @@ Vector2 Box2DCollisionObject::get_total_gravity() const {
 }
 
 double Box2DCollisionObject::get_total_linear_damp() const {
-	return box2d_to_godot(body_def->linearDamping);
+	return box2d_to_godot(body_def.linearDamping);
 }
 
 double Box2DCollisionObject::get_total_angular_damp() const {
-	return box2d_to_godot(body_def->linearDamping);
+	return box2d_to_godot(body_def.linearDamping);
 }
 
 Vector2 Box2DCollisionObject::get_center_of_mass_local() const {
+	if (!center_of_mass_set && body) {
+		return box2d_to_godot(body->GetLocalCenter());
+	}
 	return box2d_to_godot(mass_data.center);
 }
 
@@ -253,14 +276,15 @@ double Box2DCollisionObject::get_inverse_mass() const {
 	return 1.0 / mass_data.mass;
 }
 double Box2DCollisionObject::get_inverse_inertia() const {
-	if (mass_data.I <= 0) {
+	double inertia = get_inertia();
+	if (inertia <= 0 || (body && body->IsFixedRotation())) {
 		return 0;
 	}
-	return 1.0 / mass_data.I;
+	return 1.0 / inertia;
 }
 void Box2DCollisionObject::set_linear_velocity(const Vector2 &p_linear_velocity) {
 	b2Vec2 box2d_linear_velocity = godot_to_box2d(p_linear_velocity);
-	body_def->linearVelocity = box2d_linear_velocity;
+	body_def.linearVelocity = box2d_linear_velocity;
 	if (body) {
 		body->SetLinearVelocity(box2d_linear_velocity);
 	}
@@ -274,7 +298,7 @@ Vector2 Box2DCollisionObject::get_linear_velocity() const {
 }
 void Box2DCollisionObject::set_angular_velocity(double p_velocity) {
 	float angularVelocity = godot_to_box2d(p_velocity);
-	body_def->angularVelocity = angularVelocity;
+	body_def.angularVelocity = angularVelocity;
 	if (body) {
 		body->SetAngularVelocity(angularVelocity);
 	}
@@ -292,7 +316,7 @@ Transform2D Box2DCollisionObject::get_transform() const {
 	if (body) {
 		return Transform2D(body->GetAngle(), box2d_to_godot(body->GetPosition()));
 	} else {
-		return Transform2D(body_def->angle, box2d_to_godot(body_def->position));
+		return Transform2D(body_def.angle, box2d_to_godot(body_def.position));
 	}
 }
 Vector2 Box2DCollisionObject::get_velocity_at_local_position(const Vector2 &p_local_position) const {
@@ -339,22 +363,27 @@ void Box2DCollisionObject::add_constant_central_force(const Vector2 &force) {
 	constant_forces.constant_force += godot_to_box2d(force);
 	// TODO set position to center
 	//constant_force_position = position;
+	_forces_changed();
 }
 void Box2DCollisionObject::add_constant_force(const Vector2 &force, const Vector2 &position) {
 	constant_forces.constant_force += godot_to_box2d(force);
 	constant_forces.constant_force_position = godot_to_box2d(position);
+	_forces_changed();
 }
 void Box2DCollisionObject::add_constant_torque(double torque) {
 	constant_forces.constant_torque += godot_to_box2d(torque);
+	_forces_changed();
 }
 void Box2DCollisionObject::set_constant_force(const Vector2 &force) {
 	constant_forces.constant_force = godot_to_box2d(force);
+	_forces_changed();
 }
 Vector2 Box2DCollisionObject::get_constant_force() const {
 	return box2d_to_godot(constant_forces.constant_force);
 }
 void Box2DCollisionObject::set_constant_torque(double torque) {
 	constant_forces.constant_torque = godot_to_box2d(torque);
+	_forces_changed();
 }
 double Box2DCollisionObject::get_constant_torque() const {
 	return box2d_to_godot(constant_forces.constant_torque);
@@ -367,76 +396,79 @@ void Box2DCollisionObject::set_sleep_state(bool enabled) {
 bool Box2DCollisionObject::is_sleeping() const {
 	return !body->IsAwake();
 }
-Box2DCollisionObject::ContactEdgeData Box2DCollisionObject::_get_contact_edge_data(int32_t contact_idx) const {
-	if (!body) {
-		return ContactEdgeData();
+void Box2DCollisionObject::_update_contact_points() const {
+	if (contact_points_version == space->get_contacts_version()) {
+		return;
 	}
-	b2ContactEdge *contacts = body->GetContactList();
-	int32 contacts_count = 0;
-	b2WorldManifold worldManifold;
-	while (contacts) {
-		contacts_count += contacts->contact->GetManifold()->pointCount;
-		if (contacts_count > contact_idx) {
-			return ContactEdgeData{ contacts, contacts_count - contact_idx - 1 };
+	contact_points_version = space->get_contacts_version();
+	contact_points.clear();
+	for (b2ContactEdge *edge = body->GetContactList(); edge; edge = edge->next) {
+		int32 point_count = edge->contact->GetManifold()->pointCount;
+		for (int32 i = 0; i < point_count; i++) {
+			contact_points.push_back(ContactPoint{ edge->contact, edge->other, i });
 		}
-		contacts = contacts->next;
 	}
-	return ContactEdgeData();
+}
+
+const Box2DCollisionObject::ContactPoint *Box2DCollisionObject::_get_contact_point(int32_t contact_idx) const {
+	if (!body) {
+		return nullptr;
+	}
+	_update_contact_points();
+	if (contact_idx < 0 || contact_idx >= (int32_t)contact_points.size()) {
+		return nullptr;
+	}
+	return &contact_points[contact_idx];
 }
 
 int32_t Box2DCollisionObject::get_contact_count() const {
 	if (!body) {
 		return 0;
 	}
-	b2ContactEdge *contacts = body->GetContactList();
-	int32 contacts_count = 0;
-	while (contacts) {
-		contacts_count += contacts->contact->GetManifold()->pointCount;
-		contacts = contacts->next;
-	}
-	return contacts_count;
+	_update_contact_points();
+	return contact_points.size();
 }
 Vector2 Box2DCollisionObject::get_contact_local_position(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return Vector2();
 	}
 	b2WorldManifold worldManifold;
-	data.edge->contact->GetWorldManifold(&worldManifold);
-	return box2d_to_godot(worldManifold.points[data.point_idx]);
+	data->contact->GetWorldManifold(&worldManifold);
+	return box2d_to_godot(worldManifold.points[data->point_idx]);
 }
 Vector2 Box2DCollisionObject::get_contact_local_normal(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return Vector2();
 	}
-	b2Vec2 normal = data.edge->contact->GetManifold()->localNormal;
+	b2Vec2 normal = data->contact->GetManifold()->localNormal;
 	return Vector2(normal.x, normal.y);
 }
 int32_t Box2DCollisionObject::get_contact_local_shape(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return -1;
 	}
-	return data.edge->contact->GetFixtureA()->GetUserData().shape_idx;
+	return data->contact->GetFixtureA()->GetUserData().shape_idx;
 }
 RID Box2DCollisionObject::get_contact_collider(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return RID();
 	}
-	b2BodyUserData *user_data = (b2BodyUserData *)&data.edge->other->GetUserData();
+	b2BodyUserData *user_data = (b2BodyUserData *)&data->other->GetUserData();
 	return user_data->collision_object->get_self();
 }
 Vector2 Box2DCollisionObject::get_contact_collider_position(int32_t contact_idx) const {
 	return get_contact_local_position(contact_idx);
 }
 uint64_t Box2DCollisionObject::get_contact_collider_id(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return 0;
 	}
-	b2BodyUserData *user_data = (b2BodyUserData *)&data.edge->other->GetUserData();
+	b2BodyUserData *user_data = (b2BodyUserData *)&data->other->GetUserData();
 	return user_data->collision_object->get_object_instance_id();
 }
 Object *Box2DCollisionObject::get_contact_collider_object(int32_t contact_idx) const {
@@ -444,21 +476,21 @@ Object *Box2DCollisionObject::get_contact_collider_object(int32_t contact_idx) c
 	return ObjectDB::get_instance(id);
 }
 int32_t Box2DCollisionObject::get_contact_collider_shape(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return -1;
 	}
-	return data.edge->contact->GetFixtureB()->GetUserData().shape_idx;
+	return data->contact->GetFixtureB()->GetUserData().shape_idx;
 }
 Vector2 Box2DCollisionObject::get_contact_collider_velocity_at_position(int32_t contact_idx) const {
-	ContactEdgeData data = _get_contact_edge_data(contact_idx);
-	if (!data.edge) {
+	const ContactPoint *data = _get_contact_point(contact_idx);
+	if (!data) {
 		return Vector2();
 	}
 	b2WorldManifold worldManifold;
-	data.edge->contact->GetWorldManifold(&worldManifold);
-	b2Vec2 world_point = worldManifold.points[data.point_idx];
-	return box2d_to_godot(data.edge->other->GetLinearVelocityFromWorldPoint(world_point));
+	data->contact->GetWorldManifold(&worldManifold);
+	b2Vec2 world_point = worldManifold.points[data->point_idx];
+	return box2d_to_godot(data->other->GetLinearVelocityFromWorldPoint(world_point));
 }
 Vector2 Box2DCollisionObject::get_contact_impulse(int32_t contact_idx) const {
 	return get_contact_local_normal(contact_idx) * get_step();
@@ -474,20 +506,15 @@ void Box2DCollisionObject::integrate_forces() {
 }
 
 PhysicsDirectSpaceState2D *Box2DCollisionObject::get_space_state() {
-	if (!direct_space) {
-		direct_space = memnew(Box2DDirectSpaceState);
-		direct_space->space = space;
-	}
-	return direct_space;
+	ERR_FAIL_COND_V(!space, nullptr);
+	return space->get_direct_state();
 }
 
 // Physics Server
 
 void Box2DCollisionObject::set_collision_layer(uint32_t layer) {
 	filter.categoryBits = layer;
-	if (body) {
-		_update_shapes();
-	}
+	_queue_update(UPDATE_FILTER);
 }
 
 uint32_t Box2DCollisionObject::get_collision_layer() const {
@@ -495,9 +522,7 @@ uint32_t Box2DCollisionObject::get_collision_layer() const {
 }
 void Box2DCollisionObject::set_collision_mask(uint32_t layer) {
 	filter.maskBits = layer;
-	if (body) {
-		_update_shapes();
-	}
+	_queue_update(UPDATE_FILTER);
 }
 
 uint32_t Box2DCollisionObject::get_collision_mask() const {
@@ -506,9 +531,6 @@ uint32_t Box2DCollisionObject::get_collision_mask() const {
 
 void Box2DCollisionObject::set_pickable(bool p_pickable) {
 	collision.pickable = p_pickable;
-	if (body) {
-		_update_shapes();
-	}
 }
 
 void Box2DCollisionObject::set_object_instance_id(const ObjectID &p_instance_id) {
@@ -533,29 +555,35 @@ ObjectID Box2DCollisionObject::get_canvas_instance_id() const { return canvas_in
 Box2DSpace *Box2DCollisionObject::get_space() const { return space; }
 
 void Box2DCollisionObject::add_shape(Box2DShape *p_shape, const Transform2D &p_transform, bool p_disabled) {
+	p_shape->add_owner(this);
 	Shape s;
 	s.shape = p_shape;
 	s.xform = p_transform;
 	s.disabled = p_disabled;
 	shapes.push_back(s);
 
-	// TODO (queue) update
+	_queue_update(UPDATE_FIXTURES);
 }
 
 void Box2DCollisionObject::set_shape(int p_index, Box2DShape *p_shape) {
 	ERR_FAIL_INDEX(p_index, shapes.size());
-	//shapes[p_index].shape->remove_owner(this);
-	shapes.write[p_index].shape = p_shape;
+	Shape &shape = shapes.write[p_index];
+	shape.shape->remove_owner(this);
+	shape.shape = p_shape;
+	shape.shape->add_owner(this);
 
-	// TODO: (queue) update
+	shape.needs_rebuild = true;
+	_queue_update(UPDATE_FIXTURES);
 }
 
 void Box2DCollisionObject::set_shape_transform(int p_index, const Transform2D &p_transform) {
 	ERR_FAIL_INDEX(p_index, shapes.size());
 
-	shapes.write[p_index].xform = p_transform;
+	Shape &shape = shapes.write[p_index];
+	shape.xform = p_transform;
 
-	// TODO: (queue) update
+	shape.needs_rebuild = true;
+	_queue_update(UPDATE_FIXTURES);
 }
 
 void Box2DCollisionObject::set_shape_disabled(int p_index, bool p_disabled) {
@@ -568,19 +596,8 @@ void Box2DCollisionObject::set_shape_disabled(int p_index, bool p_disabled) {
 
 	shape.disabled = p_disabled;
 
-	if (!space) {
-		return;
-	}
-
-	for (int j = 0; j < shape.fixtures.size(); j++) {
-		if (body) {
-			body->DestroyFixture(shape.fixtures[j]);
-		}
-		shape.fixtures.write[j] = nullptr;
-	}
-	shape.fixtures.clear();
-
-	// TODO: (queue) update
+	shape.needs_rebuild = true;
+	_queue_update(UPDATE_FIXTURES);
 }
 
 void Box2DCollisionObject::set_shape_as_one_way_collision(int p_index, bool enable) {
@@ -593,7 +610,8 @@ void Box2DCollisionObject::set_shape_as_one_way_collision(int p_index, bool enab
 
 	shape.one_way_collision = enable;
 
-	_update_shapes();
+	shape.needs_rebuild = true;
+	_queue_update(UPDATE_FIXTURES);
 }
 
 void Box2DCollisionObject::remove_shape(Box2DShape *p_shape) {
@@ -607,40 +625,75 @@ void Box2DCollisionObject::remove_shape(Box2DShape *p_shape) {
 }
 
 void Box2DCollisionObject::recreate_shapes() {
-	// todo make it work with one shape
 	_clear_fixtures();
 	_update_shapes();
 }
 
+void Box2DCollisionObject::shape_changed(Box2DShape *p_shape) {
+	for (int i = 0; i < shapes.size(); i++) {
+		if (shapes[i].shape == p_shape) {
+			shapes.write[i].needs_rebuild = true;
+		}
+	}
+	_queue_update(UPDATE_FIXTURES);
+}
+
+void Box2DCollisionObject::_queue_update(uint32_t p_updates) {
+	pending_updates |= p_updates;
+	// without a body there are no fixtures, they're all built when it's added to a space
+	if (space && body && !pending_update_list.in_list()) {
+		space->object_add_to_pending_update_list(&pending_update_list);
+	}
+}
+
+void Box2DCollisionObject::update_pending() {
+	uint32_t updates = pending_updates;
+	pending_updates = 0;
+	if (updates & UPDATE_FIXTURES) {
+		for (int i = 0; i < shapes.size(); i++) {
+			if (shapes[i].needs_rebuild) {
+				_destroy_fixtures(shapes.write[i]);
+			}
+		}
+	}
+	_update_shapes(updates);
+}
+
 void Box2DCollisionObject::remove_shape(int p_index) {
 	//remove anything from shape to be erased to end, so subindices don't change
 	ERR_FAIL_INDEX(p_index, shapes.size());
+	_destroy_fixtures(shapes.write[p_index]);
+	shapes[p_index].shape->remove_owner(this);
+	shapes.remove_at(p_index);
+
+	// the fixtures after it carry their shape index, rebuild them
 	for (int i = p_index; i < shapes.size(); i++) {
-		Shape &shape = shapes.write[i];
-		for (int j = 0; j < shape.fixtures.size(); j++) {
-			// should never get here with a null owner
-			if (body) {
-				body->DestroyFixture(shape.fixtures[j]);
-			}
-			shape.fixtures.write[j] = nullptr;
-		}
-		shape.fixtures.clear();
+		shapes.write[i].needs_rebuild = true;
 	}
-	shapes.remove_at(p_index);
+	_queue_update(UPDATE_FIXTURES);
+}
 
-	// TODO: (queue) update
+void Box2DCollisionObject::_destroy_fixtures(Shape &p_shape) {
+	if (p_shape.fixtures.is_empty()) {
+		return;
+	}
+	Box2DSpaceAllocator::Scope allocator_scope(space ? space->get_allocator() : nullptr);
+	for (int j = 0; j < p_shape.fixtures.size(); j++) {
+		// should never get here with a null owner
+		if (body) {
+			body->DestroyFixture(p_shape.fixtures[j]);
+		}
+		p_shape.fixtures.write[j] = nullptr;
+	}
+	p_shape.fixtures.clear();
+	// destroying fixtures destroys their contacts, the cached points would dangle
+	contact_points.clear();
+	contact_points_version = UINT64_MAX;
 }
 
 void Box2DCollisionObject::_clear_fixtures() {
 	for (int i = 0; i < shapes.size(); i++) {
-		Shape &shape = shapes.write[i];
-		for (int j = 0; j < shape.fixtures.size(); j++) {
-			if (body) {
-				body->DestroyFixture(shape.fixtures[j]);
-			}
-			shape.fixtures.write[j] = nullptr;
-		}
-		shape.fixtures.clear();
+		_destroy_fixtures(shapes.write[i]);
 	}
 }
 
@@ -648,16 +701,23 @@ void Box2DCollisionObject::_set_space(Box2DSpace *p_space) {
 	if (space) {
 		// NOTE: Remember the transform by copying it from the b2Body to the b2BodyDef.
 		if (body) {
-			body_def->position = body->GetPosition();
-			body_def->angle = body->GetAngle();
+			body_def.position = body->GetPosition();
+			body_def.angle = body->GetAngle();
 		}
 
 		_clear_fixtures();
+		if (pending_update_list.in_list()) {
+			space->object_remove_from_pending_update_list(&pending_update_list);
+		}
 		space->remove_object(this);
 	}
 	space = p_space;
+	// the contacts version of another space says nothing about the cached points
+	contact_points.clear();
+	contact_points_version = UINT64_MAX;
 	if (space) {
 		space->add_object(this);
+		pending_updates = 0;
 		_update_shapes();
 	}
 }
@@ -675,6 +735,7 @@ const Transform2D &Box2DCollisionObject::get_shape_transform(int p_index) const
 
 void Box2DCollisionObject::set_gravity_scale(real_t p_gravity_scale) {
 	gravity_scale = p_gravity_scale; // no need to convert
+	_forces_changed();
 }
 
 real_t Box2DCollisionObject::get_gravity_scale() {
@@ -682,28 +743,42 @@ real_t Box2DCollisionObject::get_gravity_scale() {
 }
 
 void Box2DCollisionObject::add_collision_exception(Box2DCollisionObject *excepted_body) {
-	collision_exception.insert(excepted_body);
+	if (!collision_exception) {
+		collision_exception = memnew(HashSet<Box2DCollisionObject *>);
+	}
+	collision_exception->insert(excepted_body);
 }
 void Box2DCollisionObject::remove_collision_exception(Box2DCollisionObject *excepted_body) {
-	collision_exception.erase(excepted_body);
+	if (!collision_exception) {
+		return;
+	}
+	collision_exception->erase(excepted_body);
+	if (collision_exception->is_empty()) {
+		memdelete(collision_exception);
+		collision_exception = nullptr;
+	}
 }
 
 bool Box2DCollisionObject::is_body_collision_excepted(Box2DCollisionObject *excepted_body) {
-	return collision_exception.has(excepted_body);
+	return collision_exception && collision_exception->has(excepted_body);
 }
 TypedArray<RID> Box2DCollisionObject::get_collision_exception() {
 	TypedArray<RID> array;
-	for (Box2DCollisionObject *E : collision_exception) {
-		array.append(E->get_self());
+	if (collision_exception) {
+		for (Box2DCollisionObject *E : *collision_exception) {
+			array.append(E->get_self());
+		}
 	}
 	return array;
 }
 // MISC
 
-void Box2DCollisionObject::_update_shapes() {
+void Box2DCollisionObject::_update_shapes(uint32_t p_updates) {
 	if (!space || !body) {
 		return;
 	}
+	Box2DSpaceAllocator::Scope allocator_scope(space->get_allocator());
+	bool created_fixtures = false;
 
 	for (int i = 0; i < shapes.size(); i++) {
 		Shape &s = shapes.write[i];
@@ -715,11 +790,14 @@ void Box2DCollisionObject::_update_shapes() {
 		//Transform2D xform = transform * s.xform;
 		bool is_static = body->GetType() == b2_staticBody;
 		if (s.fixtures.is_empty()) {
-			int box2d_shape_count = s.shape->get_b2Shape_count(is_static);
+			s.needs_rebuild = false;
+			const LocalVector<b2Shape *> &box2d_shapes = s.shape->get_prepared_b2Shapes(s.xform, s.one_way_collision, is_static);
+			int box2d_shape_count = box2d_shapes.size();
 			s.fixtures.resize(box2d_shape_count);
 			for (int j = 0; j < box2d_shape_count; j++) {
 				b2FixtureDef fixture_def;
-				fixture_def.shape = s.shape->get_transformed_b2Shape(j, s.xform, s.one_way_collision, is_static);
+				// the fixture copies the shape
+				fixture_def.shape = box2d_shapes[j];
 				if (fixture_def.shape == nullptr) {
 					ERR_PRINT("Shape " + itos(j) + " disabled.");
 					s.disabled = true;
@@ -733,58 +811,93 @@ void Box2DCollisionObject::_update_shapes() {
 				fixture_def.userData.shape_idx = i;
 				fixture_def.userData.box2d_fixture_idx = j;
 				s.fixtures.write[j] = body->CreateFixture(&fixture_def);
+				created_fixtures = true;
 			}
-		} else {
-			int box2d_shape_count = s.shape->get_b2Shape_count(is_static);
-			for (int j = 0; j < box2d_shape_count; j++) {
+		} else if (p_updates & (UPDATE_FILTER | UPDATE_MATERIAL)) {
+			// the shape data may have changed since, go by the fixtures that exist
+			for (int j = 0; j < s.fixtures.size(); j++) {
 				b2Fixture *fixture = s.fixtures[j];
-				fixture->SetFilterData(filter);
-				fixture->SetFriction(physics_material.friction);
-				fixture->SetRestitution(physics_material.bounce);
+				const b2Filter &fixture_filter = fixture->GetFilterData();
+				// SetFilterData touches the broadphase proxy, which makes the next step query pairs for it again
+				if ((p_updates & UPDATE_FILTER) && (fixture_filter.categoryBits != filter.categoryBits || fixture_filter.maskBits != filter.maskBits || fixture_filter.groupIndex != filter.groupIndex)) {
+					fixture->SetFilterData(filter);
+				}
+				if (p_updates & UPDATE_MATERIAL) {
+					fixture->SetFriction(physics_material.friction);
+					fixture->SetRestitution(physics_material.bounce);
+				}
 			}
 		}
 
 		//space->get_broadphase()->move(s.bpid, shape_aabb);
 	}
-}
-void Box2DCollisionObject::before_step() {
-	if (body) {
-		// custom gravity
-		body->ApplyForceToCenter(body->GetMass() * gravity_scale * total_gravity, false);
-		if (constant_forces.constant_force != b2Vec2_zero) {
-			// constant force
-			body->ApplyForce(body->GetMass() * constant_forces.constant_force, constant_forces.constant_force_position + body->GetPosition(), true);
-		}
-		if (constant_forces.constant_torque != 0) {
-			// constant torque
-			body->ApplyTorque(body->GetMass() * constant_forces.constant_torque, true);
-		}
+	if (created_fixtures) {
+		// creating fixtures recomputed the mass from their density, keep the configured values
+		_apply_mass_data();
 	}
 }
-
 Box2DCollisionObject::Type Box2DCollisionObject::get_type() const { return type; }
 
 void Box2DCollisionObject::set_self(const RID &p_self) { self = p_self; }
 RID Box2DCollisionObject::get_self() const { return self; }
 
-void Box2DCollisionObject::add_area(Box2DArea *p_area) {
-	areas.append(p_area);
-	areas.sort();
+void Box2DCollisionObject::_insert_area(Box2DAreaMembership *p_membership) {
+	// binary search for the first area with a lower priority, areas of equal priority keep their order
+	double priority = p_membership->area->get_priority();
+	uint32_t low = 0;
+	uint32_t high = areas.size();
+	while (low < high) {
+		uint32_t middle = (low + high) / 2;
+		if (areas[middle]->area->get_priority() >= priority) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	areas.insert(low, p_membership);
+	for (uint32_t i = low; i < areas.size(); i++) {
+		areas[i]->object_index = i;
+	}
+}
+void Box2DCollisionObject::_erase_area(Box2DAreaMembership *p_membership) {
+	uint32_t index = p_membership->object_index;
+	ERR_FAIL_COND(index >= areas.size() || areas[index] != p_membership);
+	areas.remove_at(index);
+	for (uint32_t i = index; i < areas.size(); i++) {
+		areas[i]->object_index = i;
+	}
+}
+Box2DAreaMembership *Box2DCollisionObject::find_area_membership(const Box2DArea *p_area) const {
+	// only as many entries as overlapping areas
+	for (Box2DAreaMembership *membership : areas) {
+		if (membership->area == p_area) {
+			return membership;
+		}
+	}
+	return nullptr;
+}
+void Box2DCollisionObject::add_area(Box2DAreaMembership *p_membership) {
+	_insert_area(p_membership);
 	recalculate_total_gravity();
 	recalculate_total_angular_damp();
 	recalculate_total_linear_damp();
 }
-void Box2DCollisionObject::sort_areas() {
-	areas.sort();
+void Box2DCollisionObject::area_priority_changed(Box2DAreaMembership *p_membership) {
+	_erase_area(p_membership);
+	_insert_area(p_membership);
+	recalculate_total_gravity();
+	recalculate_total_angular_damp();
+	recalculate_total_linear_damp();
 }
 void Box2DCollisionObject::recalculate_total_gravity() {
 	total_gravity = b2Vec2_zero;
 	// compute gravity from other areas
 	bool keep_computing = true;
-	for (Box2DArea *area : areas) {
+	for (Box2DAreaMembership *membership : areas) {
 		if (!keep_computing) {
 			break;
 		}
+		const Box2DArea *area = membership->area;
 		b2Vec2 area_gravity = area->get_b2_gravity(get_transform());
 
 		switch (area->get_gravity_override_mode()) {
@@ -806,55 +919,79 @@ void Box2DCollisionObject::recalculate_total_gravity() {
 			}
 		}
 	}
+	_forces_changed();
 }
-void Box2DCollisionObject::remove_area(Box2DArea *p_area) {
-	areas.erase(p_area);
-	areas.sort();
+void Box2DCollisionObject::remove_area(Box2DAreaMembership *p_membership) {
+	_erase_area(p_membership);
 	recalculate_total_gravity();
 	recalculate_total_angular_damp();
 	recalculate_total_linear_damp();
 }
 
-b2BodyDef *Box2DCollisionObject::get_b2BodyDef() { return body_def; }
-void Box2DCollisionObject::set_b2BodyDef(b2BodyDef *p_body_def) { body_def = p_body_def; }
+b2BodyDef *Box2DCollisionObject::get_b2BodyDef() { return &body_def; }
 b2Body *Box2DCollisionObject::get_b2Body() { return body; }
 void Box2DCollisionObject::set_b2Body(b2Body *p_body) {
 	body = p_body;
 	// set additional properties here
 	if (body) {
-		body->SetMassData(&mass_data);
+		_apply_mass_data();
 		body->SetAwake(true);
 		//recreate_shapes();
 	}
 }
 
-void Box2DCollisionObject::_set_transform(const Transform2D &p_transform, bool p_update_shapes) {
+void Box2DCollisionObject::_set_transform(const Transform2D &p_transform) {
+	// Fixtures are in body space, so moving the body doesn't need to update them.
 	if (body) {
 		Vector2 pos = p_transform.get_origin();
 		b2Vec2 box2d_pos;
 		godot_to_box2d(pos, box2d_pos);
-		body->SetTransform(box2d_pos, p_transform.get_rotation());
+		float angle = p_transform.get_rotation();
+		if (box2d_pos == body->GetPosition() && angle == body->GetAngle()) {
+			// SetTransform would still move every proxy in the broadphase
+			return;
+		}
+		// grows the broadphase move buffer
+		Box2DSpaceAllocator::Scope allocator_scope(space->get_allocator());
+		body->SetTransform(box2d_pos, angle);
 	} else {
-		godot_to_box2d(p_transform.get_origin(), body_def->position);
-		body_def->angle = p_transform.get_rotation();
-	}
-	if (p_update_shapes) {
-		_update_shapes();
+		godot_to_box2d(p_transform.get_origin(), body_def.position);
+		body_def.angle = p_transform.get_rotation();
 	}
 }
 
-Box2DCollisionObject::Box2DCollisionObject(Type p_type) {
+Box2DCollisionObject::Box2DCollisionObject(Type p_type) :
+		pending_update_list(this) {
 	type = p_type;
-	body_def = memnew(b2BodyDef);
-	body_def->userData.collision_object = this;
+	body_def.userData.collision_object = this;
 	reset_mass_properties();
 }
 
 Box2DCollisionObject::~Box2DCollisionObject() {
-	for (Box2DArea *area : areas) {
-		if (area) {
-			area->remove_body(this);
-		}
+	if (pending_update_list.in_list()) {
+		space->object_remove_from_pending_update_list(&pending_update_list);
+	}
+	for (const Shape &shape : shapes) {
+		shape.shape->remove_owner(this);
+	}
+	for (Box2DAreaMembership *membership : areas) {
+		membership->area->drop_membership(membership);
+	}
+	if (collision_exception) {
+		memdelete(collision_exception);
+	}
+}
+
+int64_t Box2DCollisionObject::get_memory_footprint() const {
+	int64_t size = sizeof(Box2DCollisionObject);
+	size += shapes.size() * sizeof(Shape);
+	for (const Shape &shape : shapes) {
+		size += shape.fixtures.size() * sizeof(b2Fixture *);
+	}
+	size += areas.size() * sizeof(Box2DAreaMembership *);
+	if (collision_exception) {
+		// keys plus the hash and the two index tables
+		size += sizeof(HashSet<Box2DCollisionObject *>) + collision_exception->get_capacity() * (sizeof(Box2DCollisionObject *) + 3 * sizeof(uint32_t));
 	}
-	memdelete(body_def);
+	return size;
 }
@@ -3,6 +3,8 @@
 #include <godot_cpp/classes/physics_server2d.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/self_list.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/rid.hpp>
 
@@ -18,6 +20,17 @@ using namespace godot;
 class Box2DDirectSpaceState;
 class Box2DJoint;
 class Box2DArea;
+class Box2DCollisionObject;
+
+// Links an object to an area it's in. Both sides point to it and it knows its index in both lists,
+// so either side can drop it without searching.
+struct Box2DAreaMembership {
+	Box2DArea *area = nullptr;
+	Box2DCollisionObject *object = nullptr;
+	uint32_t area_index = 0; // in Box2DArea::bodies
+	uint32_t object_index = 0; // in Box2DCollisionObject::areas
+	uint32_t overlap_count = 0; // the area reports each overlapping shape pair
+};
 
 class Box2DCollisionObject {
 public:
@@ -30,16 +43,16 @@ public:
 	}
 
 protected:
+	// Fields read while stepping and in contact callbacks come first, so they share cache lines.
+	// Per step force data is mirrored into the space arrays.
 	Type type;
-	RID self;
-	ObjectID object_instance_id;
-	ObjectID canvas_instance_id;
-
+	b2Filter filter;
 	b2Body *body = nullptr;
-	b2BodyDef *body_def = nullptr;
 	Box2DSpace *space = nullptr;
-	HashSet<Box2DCollisionObject *> collision_exception;
-	Vector<Box2DArea *> areas;
+	// only allocated once an exception is added, most objects never have one
+	HashSet<Box2DCollisionObject *> *collision_exception = nullptr;
+	RID self;
+	ObjectID object_instance_id;
 
 	struct Shape {
 		Transform2D xform;
@@ -47,14 +60,30 @@ protected:
 		Vector<b2Fixture *> fixtures;
 		bool disabled = false;
 		bool one_way_collision = false;
+		bool needs_rebuild = false; // fixtures don't match the shape, its transform or flags anymore
 	};
 	Vector<Shape> shapes;
+	LocalVector<Box2DAreaMembership *> areas; // highest priority first
+	// Changes to fixtures are collected here and applied once before the next step, so many changes
+	// in a frame cost one pass over the fixtures.
+	enum PendingUpdate {
+		UPDATE_FIXTURES = 1 << 0, // create missing fixtures and rebuild the ones marked needs_rebuild
+		UPDATE_FILTER = 1 << 1,
+		UPDATE_MATERIAL = 1 << 2,
+		UPDATE_ALL = UPDATE_FIXTURES | UPDATE_FILTER | UPDATE_MATERIAL,
+	};
+	uint32_t pending_updates = 0;
+	SelfList<Box2DCollisionObject> pending_update_list;
+
+	// Configuration below is only touched when the server changes it.
+	ObjectID canvas_instance_id;
+	// kept inline, it's needed whenever the b2Body is (re)created
+	b2BodyDef body_def;
 
 	struct Collision {
 		real_t priority = 1;
 		bool pickable = false;
 	};
-	b2Filter filter;
 	Collision collision;
 	struct ConstantForces {
 		b2Vec2 constant_force = b2Vec2_zero;
@@ -78,21 +107,37 @@ protected:
 	real_t total_angular_damp = 1;
 	b2Vec2 total_gravity = b2Vec2(0, -9.8);
 
+	void _destroy_fixtures(Shape &p_shape);
 	void _clear_fixtures();
-	void _update_shapes();
-	Box2DDirectSpaceState *direct_space = nullptr;
+	void _update_shapes(uint32_t p_updates = UPDATE_ALL);
+	void _queue_update(uint32_t p_updates);
+
+	void _insert_area(Box2DAreaMembership *p_membership);
+	void _erase_area(Box2DAreaMembership *p_membership);
 
+	// I <= 0 and an unset center mean they're computed from the fixtures, like in Godot
 	b2MassData mass_data;
+	bool center_of_mass_set = false;
+	void _apply_mass_data();
 	real_t gravity_scale = 1;
-	struct ContactEdgeData {
-		b2ContactEdge *edge;
-		int32_t point_idx;
+	// Contact points of the body in one flat array, gathered from the contact edge list on first use
+	// and reused until the contacts of the space change.
+	struct ContactPoint {
+		b2Contact *contact = nullptr;
+		b2Body *other = nullptr;
+		int32_t point_idx = 0;
 	};
+	mutable LocalVector<ContactPoint> contact_points;
+	mutable uint64_t contact_points_version = UINT64_MAX;
 
-	ContactEdgeData _get_contact_edge_data(int32_t contact_idx) const;
+	void _update_contact_points() const;
+	const ContactPoint *_get_contact_point(int32_t contact_idx) const;
+
+	// called when gravity or constant forces change, so the space can mirror them
+	virtual void _forces_changed() {}
 
 protected:
-	void _set_transform(const Transform2D &p_transform, bool p_update_shapes = true);
+	void _set_transform(const Transform2D &p_transform);
 
 	void _set_space(Box2DSpace *p_space);
 
@@ -100,6 +145,10 @@ protected:
 
 public:
 	void recreate_shapes();
+	// Called by the shape when its data changes, the fixtures made from it are rebuilt before the next step.
+	void shape_changed(Box2DShape *p_shape);
+	// Applies the queued fixture changes, called by the space.
+	void update_pending();
 	void set_linear_damp_mode(PhysicsServer2D::BodyDampMode p_linear_damp);
 	virtual void set_linear_damp(real_t p_linear_damp);
 	void set_angular_damp_mode(PhysicsServer2D::BodyDampMode p_linear_damp);
@@ -194,13 +243,14 @@ public:
 	void add_collision_exception(Box2DCollisionObject *excepted_body);
 	void remove_collision_exception(Box2DCollisionObject *excepted_body);
 	bool is_body_collision_excepted(Box2DCollisionObject *excepted_body);
+	_FORCE_INLINE_ bool has_collision_exceptions() const { return collision_exception != nullptr; }
 
 	TypedArray<RID> get_collision_exception();
 
 	virtual void set_space(Box2DSpace *p_space) = 0;
 
 	// MISC
-	void sort_areas();
+	void area_priority_changed(Box2DAreaMembership *p_membership);
 	void recalculate_total_gravity();
 	void recalculate_total_linear_damp();
 	void recalculate_total_angular_damp();
@@ -210,16 +260,18 @@ public:
 	Type get_type() const;
 	void set_self(const RID &p_self);
 	RID get_self() const;
-	virtual void add_area(Box2DArea *p_area);
-	virtual void remove_area(Box2DArea *p_area);
+	Box2DAreaMembership *find_area_membership(const Box2DArea *p_area) const;
+	void add_area(Box2DAreaMembership *p_membership);
+	void remove_area(Box2DAreaMembership *p_membership);
 
 	b2BodyDef *get_b2BodyDef();
-	void set_b2BodyDef(b2BodyDef *p_body_def);
 	b2Body *get_b2Body();
 	virtual void set_b2Body(b2Body *p_body);
 	virtual HashSet<Box2DJoint *> get_joints() { return HashSet<Box2DJoint *>(); }
 
-	void before_step();
+	// Approximate bytes used by this object and the memory it owns, not counting Box2D's own.
+	virtual int64_t get_memory_footprint() const;
+
 	Box2DCollisionObject();
 	virtual ~Box2DCollisionObject();
 };
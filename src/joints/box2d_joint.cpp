@@ -3,9 +3,6 @@
 #include "box2d_type_conversions.h"
 #include "spaces/box2d_space.h"
 
-#include <box2d/b2_distance_joint.h>
-#include <box2d/b2_prismatic_joint.h>
-#include <box2d/b2_revolute_joint.h>
 #include <godot_cpp/core/memory.hpp>
 
 #include <box2d/b2_circle_shape.h>
@@ -61,10 +58,9 @@ bool Box2DJoint::get_disable_collisions() {
 void Box2DJoint::make_pin(const Vector2 &p_anchor, Box2DBody *p_body_a, Box2DBody *p_body_b) {
 	type = PhysicsServer2D::JointType::JOINT_TYPE_PIN;
 	common.anchor_a = godot_to_box2d(p_anchor);
-	b2RevoluteJointDef *revolute_joint_def = memnew(b2RevoluteJointDef);
-	revolute_joint_def->collideConnected = joint_def->collideConnected;
-	memdelete(joint_def);
-	joint_def = revolute_joint_def;
+	bool collide_connected = joint_def->collideConnected;
+	joint_def = memnew_placement(&joint_def_storage.revolute, b2RevoluteJointDef);
+	joint_def->collideConnected = collide_connected;
 	common.body_a = p_body_a;
 	common.body_b = p_body_b;
 	// body_a and body_b are set when joint is created
@@ -78,10 +74,9 @@ void Box2DJoint::make_groove(const Vector2 &p_a_groove1, const Vector2 &p_a_groo
 	Vector2 axis = (p_a_groove1 - p_a_groove2).normalized();
 	groove.axis = b2Vec2(axis.x, axis.y);
 	common.anchor_b = godot_to_box2d(p_b_anchor);
-	b2PrismaticJointDef *prismatic_joint_def = memnew(b2PrismaticJointDef);
-	prismatic_joint_def->collideConnected = joint_def->collideConnected;
-	memdelete(joint_def);
-	joint_def = prismatic_joint_def;
+	bool collide_connected = joint_def->collideConnected;
+	joint_def = memnew_placement(&joint_def_storage.prismatic, b2PrismaticJointDef);
+	joint_def->collideConnected = collide_connected;
 	common.body_a = p_body_a;
 	common.body_b = p_body_b;
 	// body_a and body_b are set when joint is created
@@ -92,10 +87,9 @@ void Box2DJoint::make_damped_spring(const Vector2 &p_anchor_a, const Vector2 &p_
 	type = PhysicsServer2D::JointType::JOINT_TYPE_DAMPED_SPRING;
 	common.anchor_a = godot_to_box2d(p_anchor_a);
 	common.anchor_b = godot_to_box2d(p_anchor_b);
-	b2DistanceJointDef *distance_joint_def = memnew(b2DistanceJointDef);
-	distance_joint_def->collideConnected = joint_def->collideConnected;
-	memdelete(joint_def);
-	joint_def = distance_joint_def;
+	bool collide_connected = joint_def->collideConnected;
+	joint_def = memnew_placement(&joint_def_storage.distance, b2DistanceJointDef);
+	joint_def->collideConnected = collide_connected;
 	common.body_a = p_body_a;
 	common.body_b = p_body_b;
 	// body_a and body_b are set when joint is created
@@ -205,9 +199,8 @@ void Box2DJoint::set_space(Box2DSpace *p_space) {
 }
 
 Box2DJoint::Box2DJoint() {
-	joint_def = memnew(b2JointDef);
+	joint_def = memnew_placement(&joint_def_storage.base, b2JointDef);
 }
 
 Box2DJoint::~Box2DJoint() {
-	memdelete(joint_def);
 }
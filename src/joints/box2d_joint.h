@@ -7,7 +7,10 @@
 #include <godot_cpp/variant/variant.hpp>
 #include <godot_cpp/variant/vector2.hpp>
 
+#include <box2d/b2_distance_joint.h>
 #include <box2d/b2_joint.h>
+#include <box2d/b2_prismatic_joint.h>
+#include <box2d/b2_revolute_joint.h>
 
 using namespace godot;
 
@@ -44,6 +47,15 @@ class Box2DJoint {
 	CommonJoint common;
 
 	b2Joint *joint = nullptr;
+	// Room for whichever joint def the type needs, so changing the type doesn't allocate.
+	union JointDefStorage {
+		b2JointDef base;
+		b2RevoluteJointDef revolute;
+		b2PrismaticJointDef prismatic;
+		b2DistanceJointDef distance;
+		JointDefStorage() {}
+	};
+	JointDefStorage joint_def_storage;
 	b2JointDef *joint_def = nullptr;
 
 	Box2DSpace *space = nullptr;
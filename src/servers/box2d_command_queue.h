@@ -0,0 +1,74 @@
+#pragma once
+
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/spin_lock.hpp>
+
+#include <tuple>
+#include <type_traits>
+
+using namespace godot;
+
+// Records server calls made while the physics thread is stepping or from other threads, to be applied on the next sync.
+// Commands are flushed on the main thread but can be pushed from any thread, e.g. by resource loader
+// threads setting up shapes, so the list is guarded by a lock.
+class Box2DCommandQueue {
+	struct CommandBase {
+		virtual void call() = 0;
+		virtual ~CommandBase() {}
+	};
+
+	template <class T, class M, class... Args>
+	struct Command : public CommandBase {
+		T *instance;
+		M method;
+		std::tuple<std::decay_t<Args>...> args;
+
+		virtual void call() override {
+			std::apply([this](auto &...p_args) { (instance->*method)(p_args...); }, args);
+		}
+
+		Command(T *p_instance, M p_method, const Args &...p_args) :
+				instance(p_instance), method(p_method), args(p_args...) {}
+	};
+
+	LocalVector<CommandBase *> commands;
+	LocalVector<CommandBase *> flushing_commands;
+	SpinLock spin_lock;
+
+public:
+	template <class T, class M, class... Args>
+	void push(T *p_instance, M p_method, const Args &...p_args) {
+		CommandBase *command = memnew((Command<T, M, Args...>)(p_instance, p_method, p_args...));
+		spin_lock.lock();
+		commands.push_back(command);
+		spin_lock.unlock();
+	}
+
+	void flush() {
+		// The step has finished by now, so the recorded calls run directly instead of queuing again.
+		// Run them outside the lock, other threads keep pushing meanwhile.
+		while (true) {
+			spin_lock.lock();
+			for (CommandBase *command : commands) {
+				flushing_commands.push_back(command);
+			}
+			commands.clear();
+			spin_lock.unlock();
+			if (flushing_commands.is_empty()) {
+				break;
+			}
+			for (uint32_t i = 0; i < flushing_commands.size(); i++) {
+				flushing_commands[i]->call();
+				memdelete(flushing_commands[i]);
+			}
+			flushing_commands.clear();
+		}
+	}
+
+	~Box2DCommandQueue() {
+		for (CommandBase *command : commands) {
+			memdelete(command);
+		}
+	}
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/spin_lock.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+using namespace godot;
+
+// Hands out objects from pages of PAGE_SIZE slots and recycles freed slots, so creating and freeing
+// many objects doesn't go through the allocator each time and objects created together stay adjacent.
+// Objects can be created from any thread, e.g. shapes of resources loaded in the background, so slots are taken under a lock.
+template <class T, uint32_t PAGE_SIZE = 256>
+class Box2DObjectPool {
+	union Slot {
+		alignas(T) uint8_t data[sizeof(T)];
+		Slot *next_free;
+	};
+
+	LocalVector<Slot *> pages;
+	Slot *free_list = nullptr;
+	uint32_t alloc_count = 0;
+	uint32_t peak_alloc_count = 0;
+	uint64_t total_alloc_count = 0;
+	mutable SpinLock spin_lock;
+
+	void _add_page() {
+		Slot *page = (Slot *)memalloc(sizeof(Slot) * PAGE_SIZE);
+		// link backwards so slots are handed out in address order
+		for (int32_t i = PAGE_SIZE - 1; i >= 0; i--) {
+			page[i].next_free = free_list;
+			free_list = &page[i];
+		}
+		pages.push_back(page);
+	}
+
+public:
+	T *alloc() {
+		spin_lock.lock();
+		if (!free_list) {
+			_add_page();
+		}
+		Slot *slot = free_list;
+		free_list = slot->next_free;
+		alloc_count++;
+		total_alloc_count++;
+		peak_alloc_count = MAX(peak_alloc_count, alloc_count);
+		spin_lock.unlock();
+		// construct outside the lock, constructors may allocate
+		return memnew_placement(slot->data, T);
+	}
+
+	void free(T *p_object) {
+		ERR_FAIL_COND(!p_object);
+		p_object->~T();
+		Slot *slot = (Slot *)p_object;
+		spin_lock.lock();
+		slot->next_free = free_list;
+		free_list = slot;
+		alloc_count--;
+		spin_lock.unlock();
+	}
+
+	uint32_t get_alloc_count() const {
+		spin_lock.lock();
+		uint32_t current_alloc_count = alloc_count;
+		spin_lock.unlock();
+		return current_alloc_count;
+	}
+
+	Dictionary get_statistics() const {
+		spin_lock.lock();
+		uint32_t page_count = pages.size();
+		uint32_t current_alloc_count = alloc_count;
+		uint32_t current_peak_alloc_count = peak_alloc_count;
+		uint64_t current_total_alloc_count = total_alloc_count;
+		spin_lock.unlock();
+
+		Dictionary statistics;
+		statistics["object_size"] = (int64_t)sizeof(T);
+		statistics["page_count"] = (int64_t)page_count;
+		statistics["capacity"] = (int64_t)page_count * PAGE_SIZE;
+		statistics["alloc_count"] = (int64_t)current_alloc_count;
+		statistics["peak_alloc_count"] = (int64_t)current_peak_alloc_count;
+		statistics["total_alloc_count"] = (int64_t)current_total_alloc_count;
+		return statistics;
+	}
+
+	~Box2DObjectPool() {
+		if (alloc_count > 0) {
+			// the RIDs were never freed, their destructors don't run, only the memory is released
+			ERR_PRINT(itos(alloc_count) + " pooled physics objects leaked at exit.");
+		}
+		for (Slot *page : pages) {
+			memfree(page);
+		}
+	}
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/rid_owner.hpp>
+#include <godot_cpp/templates/spin_lock.hpp>
+#include <godot_cpp/variant/rid.hpp>
+
+#include <atomic>
+
+using namespace godot;
+
+// Maps RIDs to object pointers like RID_PtrOwner<T, true>, but resolving a RID takes no lock.
+// The table of chunks is allocated once and slots never move, so a lookup racing make_rid or free
+// sees either the object or null. Only making and freeing RIDs take the lock.
+template <class T>
+class Box2DRIDOwner : public RID_AllocBase {
+	static constexpr uint32_t CHUNK_SIZE = 4096;
+	static constexpr uint32_t MAX_CHUNKS = 4096; // up to 16M objects
+	static constexpr uint32_t INVALID_VALIDATOR = 0xFFFFFFFF;
+
+	struct Slot {
+		std::atomic<uint32_t> validator;
+		std::atomic<T *> object;
+	};
+
+	std::atomic<Slot *> chunks[MAX_CHUNKS] = {};
+	uint32_t chunk_count = 0;
+	LocalVector<uint32_t> free_indices;
+	uint32_t alloc_count = 0;
+	SpinLock spin_lock;
+
+	_FORCE_INLINE_ Slot *_get_slot(const RID &p_rid) const {
+		uint64_t id = (uint64_t)p_rid.get_id();
+		uint32_t index = id & 0xFFFFFFFF;
+		uint32_t chunk = index / CHUNK_SIZE;
+		if (unlikely(chunk >= MAX_CHUNKS)) {
+			return nullptr;
+		}
+		Slot *slots = chunks[chunk].load(std::memory_order_acquire);
+		if (unlikely(!slots)) {
+			return nullptr;
+		}
+		return &slots[index % CHUNK_SIZE];
+	}
+
+public:
+	RID make_rid(T *p_object) {
+		spin_lock.lock();
+		if (free_indices.is_empty()) {
+			if (chunk_count == MAX_CHUNKS) {
+				spin_lock.unlock();
+				ERR_FAIL_V_MSG(RID(), "Too many physics objects.");
+			}
+			Slot *slots = (Slot *)memalloc(sizeof(Slot) * CHUNK_SIZE);
+			for (uint32_t i = 0; i < CHUNK_SIZE; i++) {
+				memnew_placement(&slots[i], Slot);
+				slots[i].validator.store(INVALID_VALIDATOR, std::memory_order_relaxed);
+				slots[i].object.store(nullptr, std::memory_order_relaxed);
+			}
+			// hand out the lowest indices first
+			for (int32_t i = CHUNK_SIZE - 1; i >= 0; i--) {
+				free_indices.push_back(chunk_count * CHUNK_SIZE + i);
+			}
+			chunks[chunk_count].store(slots, std::memory_order_release);
+			chunk_count++;
+		}
+		uint32_t index = free_indices[free_indices.size() - 1];
+		free_indices.resize(free_indices.size() - 1);
+		// taken from the id counter shared by all owners, so RIDs of different owners don't alias
+		uint32_t validator = _gen_id() & 0x7FFFFFFF;
+		if (validator == 0) {
+			validator = 1; // would be the null RID for index 0
+		}
+		alloc_count++;
+
+		Slot &slot = chunks[index / CHUNK_SIZE].load(std::memory_order_relaxed)[index % CHUNK_SIZE];
+		slot.object.store(p_object, std::memory_order_relaxed);
+		// readers check the validator first, so publish it last
+		slot.validator.store(validator, std::memory_order_release);
+		spin_lock.unlock();
+
+		return _make_from_id((uint64_t(validator) << 32) | index);
+	}
+
+	_FORCE_INLINE_ T *get_or_null(const RID &p_rid) const {
+		Slot *slot = _get_slot(p_rid);
+		if (unlikely(!slot)) {
+			return nullptr;
+		}
+		uint32_t validator = (uint64_t)p_rid.get_id() >> 32;
+		if (unlikely(slot->validator.load(std::memory_order_acquire) != validator)) {
+			return nullptr;
+		}
+		T *object = slot->object.load(std::memory_order_acquire);
+		// freed while reading
+		if (unlikely(slot->validator.load(std::memory_order_acquire) != validator)) {
+			return nullptr;
+		}
+		return object;
+	}
+
+	_FORCE_INLINE_ bool owns(const RID &p_rid) const {
+		return get_or_null(p_rid) != nullptr;
+	}
+
+	void free(const RID &p_rid) {
+		spin_lock.lock();
+		Slot *slot = _get_slot(p_rid);
+		uint32_t validator = (uint64_t)p_rid.get_id() >> 32;
+		if (!slot || slot->validator.load(std::memory_order_relaxed) != validator) {
+			spin_lock.unlock();
+			ERR_FAIL_MSG("Attempted to free an invalid RID.");
+		}
+		// invalidate first, so readers stop before the object goes away
+		slot->validator.store(INVALID_VALIDATOR, std::memory_order_release);
+		slot->object.store(nullptr, std::memory_order_relaxed);
+		free_indices.push_back((uint64_t)p_rid.get_id() & 0xFFFFFFFF);
+		alloc_count--;
+		spin_lock.unlock();
+	}
+
+	uint32_t get_rid_count() const { return alloc_count; }
+
+	~Box2DRIDOwner() {
+		if (alloc_count > 0) {
+			WARN_PRINT("Physics RIDs leaked at exit.");
+		}
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			memfree(chunks[i].load(std::memory_order_relaxed));
+		}
+	}
+};
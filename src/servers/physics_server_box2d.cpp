@@ -1,21 +1,37 @@
 #include "physics_server_box2d.h"
 
 #include "../bodies/box2d_direct_body_state.h"
-#include "../shapes/box2d_shape_capsule.h"
-#include "../shapes/box2d_shape_circle.h"
-#include "../shapes/box2d_shape_concave_polygon.h"
-#include "../shapes/box2d_shape_convex_polygon.h"
-#include "../shapes/box2d_shape_rectangle.h"
-#include "../shapes/box2d_shape_segment.h"
-#include "../shapes/box2d_shape_separation_ray.h"
-#include "../shapes/box2d_shape_world_boundary.h"
 #include "../spaces/box2d_direct_space_state.h"
 
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
 
 #define FLUSH_QUERY_CHECK(m_object) \
 	ERR_FAIL_COND_MSG(m_object->get_space() && flushing_queries, "Can't change this state while flushing queries. Use call_deferred() or set_deferred() to change monitoring state instead.");
 
+// Only the main thread, the one that set up the server and calls step and sync, waits for the step
+// and applies queued commands. Other threads, e.g. resource loaders setting up shapes, never touch
+// state the main thread may be changing.
+static thread_local bool is_main_thread = false;
+
+// Defers a state changing call until the step running on the physics thread is done.
+// Calls from other threads are always deferred and applied by the main thread before the next step.
+#define COMMAND_QUEUE_CHECK(m_method, ...)                                    \
+	if (step_in_progress.is_set() || !is_main_thread) {                       \
+		command_queue.push(this, &PhysicsServerBox2D::m_method, __VA_ARGS__); \
+		return;                                                               \
+	}
+
+// Waits for the step running on the physics thread, so state can be read safely.
+// Other threads don't wait, they only get consistent results for objects the main thread isn't changing.
+#define SYNC_STEP_CHECK()                                         \
+	if (is_main_thread && step_in_progress.is_set()) {            \
+		const_cast<PhysicsServerBox2D *>(this)->_wait_for_step(); \
+	}
+
 using godot::PhysicsServer2D;
 
 /* SHAPE API */
@@ -24,28 +40,28 @@ RID PhysicsServerBox2D::_shape_create(ShapeType p_shape) {
 	Box2DShape *shape = nullptr;
 	switch (p_shape) {
 		case SHAPE_CIRCLE: {
-			shape = memnew(Box2DShapeCircle);
+			shape = circle_shape_pool.alloc();
 		} break;
 		case SHAPE_RECTANGLE: {
-			shape = memnew(Box2DShapeRectangle);
+			shape = rectangle_shape_pool.alloc();
 		} break;
 		case SHAPE_CAPSULE: {
-			shape = memnew(Box2DShapeCapsule);
+			shape = capsule_shape_pool.alloc();
 		} break;
 		case SHAPE_CONVEX_POLYGON: {
-			shape = memnew(Box2DShapeConvexPolygon);
+			shape = convex_polygon_shape_pool.alloc();
 		} break;
 		case SHAPE_CONCAVE_POLYGON: {
-			shape = memnew(Box2DShapeConcavePolygon);
+			shape = concave_polygon_shape_pool.alloc();
 		} break;
 		case SHAPE_SEGMENT: {
-			shape = memnew(Box2DShapeSegment);
+			shape = segment_shape_pool.alloc();
 		} break;
 		case SHAPE_WORLD_BOUNDARY: {
-			shape = memnew(Box2DShapeWorldBoundary);
+			shape = world_boundary_shape_pool.alloc();
 		} break;
 		case SHAPE_SEPARATION_RAY: {
-			shape = memnew(Box2DShapeSeparationRay);
+			shape = separation_ray_shape_pool.alloc();
 		} break;
 		default: {
 			ERR_FAIL_V_MSG(RID(), "UNSUPPORTED");
@@ -91,21 +107,25 @@ RID PhysicsServerBox2D::_concave_polygon_shape_create() {
 }
 
 void PhysicsServerBox2D::_shape_set_data(const RID &p_shape, const Variant &p_data) {
+	COMMAND_QUEUE_CHECK(_shape_set_data, p_shape, p_data);
 	Box2DShape *shape = shape_owner.get_or_null(p_shape);
 	ERR_FAIL_COND(!shape);
 	shape->set_data(p_data);
+	shape->data_changed();
 }
 
 void PhysicsServerBox2D::_shape_set_custom_solver_bias(const RID &shape, double bias) {
 }
 
 PhysicsServer2D::ShapeType PhysicsServerBox2D::_shape_get_type(const RID &p_shape) const {
+	SYNC_STEP_CHECK();
 	const Box2DShape *shape = shape_owner.get_or_null(p_shape);
 	ERR_FAIL_COND_V(!shape, SHAPE_CUSTOM);
 	return shape->get_type();
 }
 
 Variant PhysicsServerBox2D::_shape_get_data(const RID &p_shape) const {
+	SYNC_STEP_CHECK();
 	const Box2DShape *shape = shape_owner.get_or_null(p_shape);
 	ERR_FAIL_COND_V(!shape, Variant());
 	ERR_FAIL_COND_V(!shape->is_configured(), Variant());
@@ -150,6 +170,7 @@ RID PhysicsServerBox2D::_space_create() {
 }
 
 void PhysicsServerBox2D::_space_set_active(const RID &p_space, bool p_active) {
+	COMMAND_QUEUE_CHECK(_space_set_active, p_space, p_active);
 	Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND(!space);
 	if (p_active) {
@@ -160,6 +181,7 @@ void PhysicsServerBox2D::_space_set_active(const RID &p_space, bool p_active) {
 }
 
 bool PhysicsServerBox2D::_space_is_active(const RID &p_space) const {
+	SYNC_STEP_CHECK();
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND_V(!space, false);
 
@@ -167,9 +189,21 @@ bool PhysicsServerBox2D::_space_is_active(const RID &p_space) const {
 }
 
 void PhysicsServerBox2D::_space_set_param(const RID &p_space, PhysicsServer2D::SpaceParameter p_param, double p_value) {
+	COMMAND_QUEUE_CHECK(_space_set_param, p_space, p_param, p_value);
 	const Box2DSpace *space_const = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND(!space_const);
 
+	if ((int)p_param == SPACE_PARAM_SUBSTEPS) {
+		Box2DSpace *space = const_cast<Box2DSpace *>(space_const);
+		space->set_substeps((int32)p_value);
+		return;
+	}
+	if ((int)p_param == SPACE_PARAM_COMPACTION_INTERVAL) {
+		Box2DSpace *space = const_cast<Box2DSpace *>(space_const);
+		space->set_compaction_interval((int32)p_value);
+		return;
+	}
+
 	switch (p_param) {
 		case SPACE_PARAM_SOLVER_ITERATIONS: {
 			Box2DSpace *space = const_cast<Box2DSpace *>(space_const);
@@ -181,9 +215,17 @@ void PhysicsServerBox2D::_space_set_param(const RID &p_space, PhysicsServer2D::S
 }
 
 double PhysicsServerBox2D::_space_get_param(const RID &p_space, PhysicsServer2D::SpaceParameter p_param) const {
+	SYNC_STEP_CHECK();
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND_V(!space, 0);
 
+	if ((int)p_param == SPACE_PARAM_SUBSTEPS) {
+		return (double)space->get_substeps();
+	}
+	if ((int)p_param == SPACE_PARAM_COMPACTION_INTERVAL) {
+		return (double)space->get_compaction_interval();
+	}
+
 	switch (p_param) {
 		case SPACE_PARAM_SOLVER_ITERATIONS:
 			return (double)space->get_solver_iterations();
@@ -196,12 +238,14 @@ double PhysicsServerBox2D::_space_get_param(const RID &p_space, PhysicsServer2D:
 PhysicsDirectSpaceState2D *PhysicsServerBox2D::_space_get_direct_state(const RID &p_space) {
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND_V(!space, nullptr);
+	ERR_FAIL_COND_V_MSG((using_threads && !doing_sync) || space->is_locked(), nullptr, "Space state is inaccessible right now, wait for iteration or physics process notification.");
 
 	Box2DSpace *space_cast = const_cast<Box2DSpace *>(space);
 	return space_cast->get_direct_state();
 }
 
 void PhysicsServerBox2D::_space_set_debug_contacts(const RID &p_space, int32_t max_contacts) {
+	COMMAND_QUEUE_CHECK(_space_set_debug_contacts, p_space, max_contacts);
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND(!space);
 	Box2DSpace *space_cast = const_cast<Box2DSpace *>(space);
@@ -209,12 +253,14 @@ void PhysicsServerBox2D::_space_set_debug_contacts(const RID &p_space, int32_t m
 	space_cast->set_debug_contacts(max_contacts);
 }
 PackedVector2Array PhysicsServerBox2D::_space_get_contacts(const RID &p_space) const {
+	SYNC_STEP_CHECK();
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND_V(!space, PackedVector2Array());
 
 	return space->get_contacts();
 }
 int32_t PhysicsServerBox2D::_space_get_contact_count(const RID &p_space) const {
+	SYNC_STEP_CHECK();
 	const Box2DSpace *space = space_owner.get_or_null(p_space);
 	ERR_FAIL_COND_V(!space, 0);
 
@@ -224,13 +270,14 @@ int32_t PhysicsServerBox2D::_space_get_contact_count(const RID &p_space) const {
 /* AREA API */
 
 RID PhysicsServerBox2D::_area_create() {
-	Box2DArea *area = memnew(Box2DArea);
+	Box2DArea *area = area_pool.alloc();
 	RID rid = area_owner.make_rid(area);
 	area->set_self(rid);
 	return rid;
 }
 
 void PhysicsServerBox2D::_area_set_space(const RID &p_area, const RID &p_space) {
+	COMMAND_QUEUE_CHECK(_area_set_space, p_area, p_space);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -249,6 +296,7 @@ void PhysicsServerBox2D::_area_set_space(const RID &p_area, const RID &p_space)
 }
 
 RID PhysicsServerBox2D::_area_get_space(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, RID());
 
@@ -260,6 +308,7 @@ RID PhysicsServerBox2D::_area_get_space(const RID &p_area) const {
 }
 
 void PhysicsServerBox2D::_area_add_shape(const RID &p_area, const RID &p_shape, const Transform2D &p_transform, bool p_disabled) {
+	COMMAND_QUEUE_CHECK(_area_add_shape, p_area, p_shape, p_transform, p_disabled);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -270,6 +319,7 @@ void PhysicsServerBox2D::_area_add_shape(const RID &p_area, const RID &p_shape,
 }
 
 void PhysicsServerBox2D::_area_set_shape(const RID &p_area, int32_t p_shape_idx, const RID &p_shape) {
+	COMMAND_QUEUE_CHECK(_area_set_shape, p_area, p_shape_idx, p_shape);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -281,6 +331,7 @@ void PhysicsServerBox2D::_area_set_shape(const RID &p_area, int32_t p_shape_idx,
 }
 
 void PhysicsServerBox2D::_area_set_shape_transform(const RID &p_area, int32_t p_shape_idx, const Transform2D &p_transform) {
+	COMMAND_QUEUE_CHECK(_area_set_shape_transform, p_area, p_shape_idx, p_transform);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -288,6 +339,7 @@ void PhysicsServerBox2D::_area_set_shape_transform(const RID &p_area, int32_t p_
 }
 
 int32_t PhysicsServerBox2D::_area_get_shape_count(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, -1);
 
@@ -295,6 +347,7 @@ int32_t PhysicsServerBox2D::_area_get_shape_count(const RID &p_area) const {
 }
 
 RID PhysicsServerBox2D::_area_get_shape(const RID &p_area, int32_t p_shape_idx) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, RID());
 
@@ -305,6 +358,7 @@ RID PhysicsServerBox2D::_area_get_shape(const RID &p_area, int32_t p_shape_idx)
 }
 
 Transform2D PhysicsServerBox2D::_area_get_shape_transform(const RID &p_area, int32_t p_shape_idx) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, Transform2D());
 
@@ -312,6 +366,7 @@ Transform2D PhysicsServerBox2D::_area_get_shape_transform(const RID &p_area, int
 }
 
 void PhysicsServerBox2D::_area_remove_shape(const RID &p_area, int32_t p_shape_idx) {
+	COMMAND_QUEUE_CHECK(_area_remove_shape, p_area, p_shape_idx);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -319,6 +374,7 @@ void PhysicsServerBox2D::_area_remove_shape(const RID &p_area, int32_t p_shape_i
 }
 
 void PhysicsServerBox2D::_area_clear_shapes(const RID &p_area) {
+	COMMAND_QUEUE_CHECK(_area_clear_shapes, p_area);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -328,6 +384,7 @@ void PhysicsServerBox2D::_area_clear_shapes(const RID &p_area) {
 }
 
 void PhysicsServerBox2D::_area_set_shape_disabled(const RID &p_area, int32_t p_shape_idx, bool p_disabled) {
+	COMMAND_QUEUE_CHECK(_area_set_shape_disabled, p_area, p_shape_idx, p_disabled);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -335,6 +392,7 @@ void PhysicsServerBox2D::_area_set_shape_disabled(const RID &p_area, int32_t p_s
 }
 
 void PhysicsServerBox2D::_area_attach_object_instance_id(const RID &p_area, uint64_t p_id) {
+	COMMAND_QUEUE_CHECK(_area_attach_object_instance_id, p_area, p_id);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	if (!area) {
 		area = &default_area;
@@ -344,6 +402,7 @@ void PhysicsServerBox2D::_area_attach_object_instance_id(const RID &p_area, uint
 }
 
 uint64_t PhysicsServerBox2D::_area_get_object_instance_id(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	const Box2DArea *area = area_owner.get_or_null(p_area);
 	if (!area) {
 		area = &default_area;
@@ -353,6 +412,7 @@ uint64_t PhysicsServerBox2D::_area_get_object_instance_id(const RID &p_area) con
 }
 
 void PhysicsServerBox2D::_area_attach_canvas_instance_id(const RID &p_area, uint64_t p_id) {
+	COMMAND_QUEUE_CHECK(_area_attach_canvas_instance_id, p_area, p_id);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 
@@ -360,6 +420,7 @@ void PhysicsServerBox2D::_area_attach_canvas_instance_id(const RID &p_area, uint
 }
 
 uint64_t PhysicsServerBox2D::_area_get_canvas_instance_id(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, ObjectID());
 
@@ -367,6 +428,7 @@ uint64_t PhysicsServerBox2D::_area_get_canvas_instance_id(const RID &p_area) con
 }
 
 void PhysicsServerBox2D::_area_set_param(const RID &p_area, AreaParameter p_param, const Variant &p_value) {
+	COMMAND_QUEUE_CHECK(_area_set_param, p_area, p_param, p_value);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	if (!area) {
 		area = &default_area;
@@ -406,12 +468,14 @@ void PhysicsServerBox2D::_area_set_param(const RID &p_area, AreaParameter p_para
 }
 
 void PhysicsServerBox2D::_area_set_transform(const RID &p_area, const Transform2D &p_transform) {
+	COMMAND_QUEUE_CHECK(_area_set_transform, p_area, p_transform);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_transform(p_transform);
 }
 
 Variant PhysicsServerBox2D::_area_get_param(const RID &p_area, PhysicsServer2D::AreaParameter p_param) const {
+	SYNC_STEP_CHECK();
 	const Box2DArea *area = area_owner.get_or_null(p_area);
 	if (!area) {
 		area = &default_area;
@@ -452,47 +516,56 @@ Variant PhysicsServerBox2D::_area_get_param(const RID &p_area, PhysicsServer2D::
 }
 
 Transform2D PhysicsServerBox2D::_area_get_transform(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, Transform2D());
 	return area->get_transform();
 }
 
 void PhysicsServerBox2D::_area_set_collision_layer(const RID &p_area, uint32_t p_layer) {
+	COMMAND_QUEUE_CHECK(_area_set_collision_layer, p_area, p_layer);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_collision_layer(p_layer);
 }
 uint32_t PhysicsServerBox2D::_area_get_collision_layer(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, 0);
 	return area->get_collision_layer();
 }
 void PhysicsServerBox2D::_area_set_collision_mask(const RID &p_area, uint32_t p_mask) {
+	COMMAND_QUEUE_CHECK(_area_set_collision_mask, p_area, p_mask);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_collision_mask(p_mask);
 }
 uint32_t PhysicsServerBox2D::_area_get_collision_mask(const RID &p_area) const {
+	SYNC_STEP_CHECK();
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND_V(!area, 0);
 	return area->get_collision_mask();
 }
 void PhysicsServerBox2D::_area_set_monitorable(const RID &p_area, bool p_monitorable) {
+	COMMAND_QUEUE_CHECK(_area_set_monitorable, p_area, p_monitorable);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_monitorable(p_monitorable);
 }
 void PhysicsServerBox2D::_area_set_pickable(const RID &p_area, bool p_pickable) {
+	COMMAND_QUEUE_CHECK(_area_set_pickable, p_area, p_pickable);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_pickable(p_pickable);
 }
 void PhysicsServerBox2D::_area_set_monitor_callback(const RID &p_area, const Callable &p_callback) {
+	COMMAND_QUEUE_CHECK(_area_set_monitor_callback, p_area, p_callback);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_monitor_callback(p_callback);
 }
 void PhysicsServerBox2D::_area_set_area_monitor_callback(const RID &p_area, const Callable &p_callback) {
+	COMMAND_QUEUE_CHECK(_area_set_area_monitor_callback, p_area, p_callback);
 	Box2DArea *area = area_owner.get_or_null(p_area);
 	ERR_FAIL_COND(!area);
 	area->set_area_monitor_callback(p_callback);
@@ -501,7 +574,7 @@ void PhysicsServerBox2D::_area_set_area_monitor_callback(const RID &p_area, cons
 /* BODY API */
 
 RID PhysicsServerBox2D::_body_create() {
-	Box2DBody *body = memnew(Box2DBody);
+	Box2DBody *body = body_pool.alloc();
 	RID rid = body_owner.make_rid(body);
 	body->set_self(rid);
 	default_area.add_body(body);
@@ -509,6 +582,7 @@ RID PhysicsServerBox2D::_body_create() {
 }
 
 void PhysicsServerBox2D::_body_set_space(const RID &p_body, const RID &p_space) {
+	COMMAND_QUEUE_CHECK(_body_set_space, p_body, p_space);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	Box2DSpace *space = nullptr;
@@ -526,6 +600,7 @@ void PhysicsServerBox2D::_body_set_space(const RID &p_body, const RID &p_space)
 }
 
 RID PhysicsServerBox2D::_body_get_space(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, RID());
 
@@ -537,6 +612,7 @@ RID PhysicsServerBox2D::_body_get_space(const RID &p_body) const {
 }
 
 void PhysicsServerBox2D::_body_set_mode(const RID &p_body, BodyMode p_mode) {
+	COMMAND_QUEUE_CHECK(_body_set_mode, p_body, p_mode);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	FLUSH_QUERY_CHECK(body);
@@ -545,6 +621,7 @@ void PhysicsServerBox2D::_body_set_mode(const RID &p_body, BodyMode p_mode) {
 };
 
 PhysicsServer2D::BodyMode PhysicsServerBox2D::_body_get_mode(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, BODY_MODE_STATIC);
 
@@ -552,6 +629,7 @@ PhysicsServer2D::BodyMode PhysicsServerBox2D::_body_get_mode(const RID &p_body)
 };
 
 void PhysicsServerBox2D::_body_add_shape(const RID &p_body, const RID &p_shape, const Transform2D &p_transform, bool p_disabled) {
+	COMMAND_QUEUE_CHECK(_body_add_shape, p_body, p_shape, p_transform, p_disabled);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -562,6 +640,7 @@ void PhysicsServerBox2D::_body_add_shape(const RID &p_body, const RID &p_shape,
 }
 
 void PhysicsServerBox2D::_body_set_shape(const RID &p_body, int32_t p_shape_idx, const RID &p_shape) {
+	COMMAND_QUEUE_CHECK(_body_set_shape, p_body, p_shape_idx, p_shape);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -573,6 +652,7 @@ void PhysicsServerBox2D::_body_set_shape(const RID &p_body, int32_t p_shape_idx,
 }
 
 void PhysicsServerBox2D::_body_set_shape_transform(const RID &p_body, int32_t p_shape_idx, const Transform2D &p_transform) {
+	COMMAND_QUEUE_CHECK(_body_set_shape_transform, p_body, p_shape_idx, p_transform);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -580,6 +660,7 @@ void PhysicsServerBox2D::_body_set_shape_transform(const RID &p_body, int32_t p_
 }
 
 int32_t PhysicsServerBox2D::_body_get_shape_count(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, -1);
 
@@ -587,6 +668,7 @@ int32_t PhysicsServerBox2D::_body_get_shape_count(const RID &p_body) const {
 }
 
 RID PhysicsServerBox2D::_body_get_shape(const RID &p_body, int32_t p_shape_idx) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, RID());
 
@@ -597,6 +679,7 @@ RID PhysicsServerBox2D::_body_get_shape(const RID &p_body, int32_t p_shape_idx)
 }
 
 Transform2D PhysicsServerBox2D::_body_get_shape_transform(const RID &p_body, int32_t p_shape_idx) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, Transform2D());
 
@@ -604,12 +687,14 @@ Transform2D PhysicsServerBox2D::_body_get_shape_transform(const RID &p_body, int
 }
 
 void PhysicsServerBox2D::_body_remove_shape(const RID &p_body, int32_t p_shape_idx) {
+	COMMAND_QUEUE_CHECK(_body_remove_shape, p_body, p_shape_idx);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->remove_shape(p_shape_idx);
 }
 
 void PhysicsServerBox2D::_body_clear_shapes(const RID &p_body) {
+	COMMAND_QUEUE_CHECK(_body_clear_shapes, p_body);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -619,6 +704,7 @@ void PhysicsServerBox2D::_body_clear_shapes(const RID &p_body) {
 }
 
 void PhysicsServerBox2D::_body_set_shape_disabled(const RID &p_body, int32_t p_shape_idx, bool p_disabled) {
+	COMMAND_QUEUE_CHECK(_body_set_shape_disabled, p_body, p_shape_idx, p_disabled);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -626,6 +712,7 @@ void PhysicsServerBox2D::_body_set_shape_disabled(const RID &p_body, int32_t p_s
 }
 
 void PhysicsServerBox2D::_body_set_shape_as_one_way_collision(const RID &p_body, int32_t shape_idx, bool enable, double margin) {
+	COMMAND_QUEUE_CHECK(_body_set_shape_as_one_way_collision, p_body, shape_idx, enable, margin);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -633,6 +720,7 @@ void PhysicsServerBox2D::_body_set_shape_as_one_way_collision(const RID &p_body,
 }
 
 void PhysicsServerBox2D::_body_attach_object_instance_id(const RID &p_body, uint64_t p_id) {
+	COMMAND_QUEUE_CHECK(_body_attach_object_instance_id, p_body, p_id);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -640,6 +728,7 @@ void PhysicsServerBox2D::_body_attach_object_instance_id(const RID &p_body, uint
 }
 
 uint64_t PhysicsServerBox2D::_body_get_object_instance_id(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, ObjectID());
 
@@ -647,12 +736,14 @@ uint64_t PhysicsServerBox2D::_body_get_object_instance_id(const RID &p_body) con
 }
 
 void PhysicsServerBox2D::_body_attach_canvas_instance_id(const RID &p_body, uint64_t p_id) {
+	COMMAND_QUEUE_CHECK(_body_attach_canvas_instance_id, p_body, p_id);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
 	body->set_canvas_instance_id(ObjectID(p_id));
 }
 uint64_t PhysicsServerBox2D::_body_get_canvas_instance_id(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, ObjectID());
 
@@ -660,6 +751,7 @@ uint64_t PhysicsServerBox2D::_body_get_canvas_instance_id(const RID &p_body) con
 }
 
 void PhysicsServerBox2D::_body_set_state(const RID &p_body, PhysicsServer2D::BodyState p_state, const Variant &p_value) {
+	COMMAND_QUEUE_CHECK(_body_set_state, p_body, p_state, p_value);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 
@@ -670,10 +762,15 @@ Variant PhysicsServerBox2D::_body_get_state(const RID &p_body, PhysicsServer2D::
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, Variant());
 
+	if (step_in_progress.is_set()) {
+		// don't wait for the step, report the state of the last one
+		return body->get_snapshot_state(p_state);
+	}
 	return body->get_state(p_state);
 }
 
 void PhysicsServerBox2D::_body_set_state_sync_callback(const RID &p_body, const Callable &p_callable) {
+	COMMAND_QUEUE_CHECK(_body_set_state_sync_callback, p_body, p_callable);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_state_sync_callback(p_callable);
@@ -699,47 +796,56 @@ PhysicsDirectBodyState2D *PhysicsServerBox2D::_body_get_direct_state(const RID &
 }
 
 void PhysicsServerBox2D::_body_set_continuous_collision_detection_mode(const RID &p_body, PhysicsServer2D::CCDMode p_mode) {
+	COMMAND_QUEUE_CHECK(_body_set_continuous_collision_detection_mode, p_body, p_mode);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_continuous_collision_detection_mode(p_mode);
 }
 PhysicsServer2D::CCDMode PhysicsServerBox2D::_body_get_continuous_collision_detection_mode(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, PhysicsServer2D::CCDMode::CCD_MODE_DISABLED);
 	return body->get_continuous_collision_detection_mode();
 }
 void PhysicsServerBox2D::_body_set_collision_layer(const RID &p_body, uint32_t p_layer) {
+	COMMAND_QUEUE_CHECK(_body_set_collision_layer, p_body, p_layer);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_collision_layer(p_layer);
 }
 
 uint32_t PhysicsServerBox2D::_body_get_collision_layer(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 	return body->get_collision_layer();
 }
 void PhysicsServerBox2D::_body_set_collision_mask(const RID &p_body, uint32_t p_mask) {
+	COMMAND_QUEUE_CHECK(_body_set_collision_mask, p_body, p_mask);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_collision_mask(p_mask);
 }
 uint32_t PhysicsServerBox2D::_body_get_collision_mask(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 	return body->get_collision_mask();
 }
 void PhysicsServerBox2D::_body_set_collision_priority(const RID &p_body, double p_priority) {
+	COMMAND_QUEUE_CHECK(_body_set_collision_priority, p_body, p_priority);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_priority(p_priority);
 }
 double PhysicsServerBox2D::_body_get_collision_priority(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 	return body->get_priority();
 }
 void PhysicsServerBox2D::_body_set_param(const RID &p_body, PhysicsServer2D::BodyParameter p_param, const Variant &p_value) {
+	COMMAND_QUEUE_CHECK(_body_set_param, p_body, p_param, p_value);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	switch (p_param) {
@@ -778,6 +884,7 @@ void PhysicsServerBox2D::_body_set_param(const RID &p_body, PhysicsServer2D::Bod
 	}
 }
 Variant PhysicsServerBox2D::_body_get_param(const RID &p_body, PhysicsServer2D::BodyParameter p_param) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, Variant());
 	switch (p_param) {
@@ -817,81 +924,97 @@ Variant PhysicsServerBox2D::_body_get_param(const RID &p_body, PhysicsServer2D::
 	return Variant();
 }
 void PhysicsServerBox2D::_body_reset_mass_properties(const RID &p_body) {
+	COMMAND_QUEUE_CHECK(_body_reset_mass_properties, p_body);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->reset_mass_properties();
 }
 void PhysicsServerBox2D::_body_apply_central_impulse(const RID &p_body, const Vector2 &p_impulse) {
+	COMMAND_QUEUE_CHECK(_body_apply_central_impulse, p_body, p_impulse);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_central_impulse(p_impulse);
 }
 void PhysicsServerBox2D::_body_apply_torque_impulse(const RID &p_body, double p_impulse) {
+	COMMAND_QUEUE_CHECK(_body_apply_torque_impulse, p_body, p_impulse);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_torque_impulse(p_impulse);
 }
 void PhysicsServerBox2D::_body_apply_impulse(const RID &p_body, const Vector2 &p_impulse, const Vector2 &p_position) {
+	COMMAND_QUEUE_CHECK(_body_apply_impulse, p_body, p_impulse, p_position);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_impulse(p_impulse, p_position);
 }
 void PhysicsServerBox2D::_body_apply_central_force(const RID &p_body, const Vector2 &p_force) {
+	COMMAND_QUEUE_CHECK(_body_apply_central_force, p_body, p_force);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_central_force(p_force);
 }
 void PhysicsServerBox2D::_body_apply_force(const RID &p_body, const Vector2 &p_force, const Vector2 &p_position) {
+	COMMAND_QUEUE_CHECK(_body_apply_force, p_body, p_force, p_position);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_force(p_force, p_position);
 }
 void PhysicsServerBox2D::_body_apply_torque(const RID &p_body, double p_torque) {
+	COMMAND_QUEUE_CHECK(_body_apply_torque, p_body, p_torque);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->apply_torque(p_torque);
 }
 void PhysicsServerBox2D::_body_add_constant_central_force(const RID &p_body, const Vector2 &p_force) {
+	COMMAND_QUEUE_CHECK(_body_add_constant_central_force, p_body, p_force);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->add_constant_central_force(p_force);
 }
 void PhysicsServerBox2D::_body_add_constant_force(const RID &p_body, const Vector2 &p_force, const Vector2 &p_position) {
+	COMMAND_QUEUE_CHECK(_body_add_constant_force, p_body, p_force, p_position);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->add_constant_force(p_force, p_position);
 }
 void PhysicsServerBox2D::_body_add_constant_torque(const RID &p_body, double p_torque) {
+	COMMAND_QUEUE_CHECK(_body_add_constant_torque, p_body, p_torque);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->add_constant_torque(p_torque);
 }
 void PhysicsServerBox2D::_body_set_constant_force(const RID &p_body, const Vector2 &p_force) {
+	COMMAND_QUEUE_CHECK(_body_set_constant_force, p_body, p_force);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_constant_force(p_force);
 }
 Vector2 PhysicsServerBox2D::_body_get_constant_force(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, Vector2());
 	return body->get_constant_force();
 }
 void PhysicsServerBox2D::_body_set_constant_torque(const RID &p_body, double p_torque) {
+	COMMAND_QUEUE_CHECK(_body_set_constant_torque, p_body, p_torque);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_constant_torque(p_torque);
 }
 double PhysicsServerBox2D::_body_get_constant_torque(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 	return body->get_constant_torque();
 }
 void PhysicsServerBox2D::_body_set_axis_velocity(const RID &p_body, const Vector2 &p_axis_velocity) {
+	COMMAND_QUEUE_CHECK(_body_set_axis_velocity, p_body, p_axis_velocity);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_linear_velocity(p_axis_velocity);
 }
 void PhysicsServerBox2D::_body_add_collision_exception(const RID &p_body, const RID &p_excepted_body) {
+	COMMAND_QUEUE_CHECK(_body_add_collision_exception, p_body, p_excepted_body);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	Box2DBody *excepted_body = body_owner.get_or_null(p_excepted_body);
 	ERR_FAIL_COND(!body);
@@ -899,6 +1022,7 @@ void PhysicsServerBox2D::_body_add_collision_exception(const RID &p_body, const
 	body->add_collision_exception(body);
 }
 void PhysicsServerBox2D::_body_remove_collision_exception(const RID &p_body, const RID &p_excepted_body) {
+	COMMAND_QUEUE_CHECK(_body_remove_collision_exception, p_body, p_excepted_body);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	Box2DBody *excepted_body = body_owner.get_or_null(p_excepted_body);
 	ERR_FAIL_COND(!body);
@@ -906,17 +1030,20 @@ void PhysicsServerBox2D::_body_remove_collision_exception(const RID &p_body, con
 	body->remove_collision_exception(body);
 }
 TypedArray<RID> PhysicsServerBox2D::_body_get_collision_exceptions(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, TypedArray<RID>());
 	return body->get_collision_exception();
 }
 
 void PhysicsServerBox2D::_body_set_max_contacts_reported(const RID &p_body, int32_t p_amount) {
+	COMMAND_QUEUE_CHECK(_body_set_max_contacts_reported, p_body, p_amount);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	body->set_max_contacts_reported(p_amount);
 }
 int32_t PhysicsServerBox2D::_body_get_max_contacts_reported(const RID &p_body) const {
+	SYNC_STEP_CHECK();
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 	return body->get_max_contacts_reported();
@@ -938,6 +1065,7 @@ bool PhysicsServerBox2D::_body_collide_shape(const RID &p_body, int32_t p_body_s
 	return false;
 }
 void PhysicsServerBox2D::_body_set_pickable(const RID &p_body, bool p_pickable) {
+	COMMAND_QUEUE_CHECK(_body_set_pickable, p_body, p_pickable);
 	Box2DBody *body = body_owner.get_or_null(p_body);
 	ERR_FAIL_COND(!body);
 	return body->set_pickable(p_pickable);
@@ -950,18 +1078,20 @@ bool PhysicsServerBox2D::_body_test_motion(const RID &p_body, const Transform2D
 /* JOINT API */
 
 RID PhysicsServerBox2D::_joint_create() {
-	Box2DJoint *joint = memnew(Box2DJoint);
+	Box2DJoint *joint = joint_pool.alloc();
 	ERR_FAIL_COND_V(!joint, RID());
 	RID id = joint_owner.make_rid(joint);
 	joint->set_self(id);
 	return id;
 }
 void PhysicsServerBox2D::_joint_clear(const RID &p_joint) {
+	COMMAND_QUEUE_CHECK(_joint_clear, p_joint);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND(!joint);
 	joint->clear();
 }
 void PhysicsServerBox2D::_joint_set_param(const RID &p_joint, PhysicsServer2D::JointParam p_param, double p_value) {
+	COMMAND_QUEUE_CHECK(_joint_set_param, p_joint, p_param, p_value);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND(!joint);
 	switch (p_param) {
@@ -977,6 +1107,7 @@ void PhysicsServerBox2D::_joint_set_param(const RID &p_joint, PhysicsServer2D::J
 	}
 }
 double PhysicsServerBox2D::_joint_get_param(const RID &p_joint, PhysicsServer2D::JointParam p_param) const {
+	SYNC_STEP_CHECK();
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND_V(!joint, 0);
 	switch (p_param) {
@@ -990,16 +1121,19 @@ double PhysicsServerBox2D::_joint_get_param(const RID &p_joint, PhysicsServer2D:
 	return 0;
 }
 void PhysicsServerBox2D::_joint_disable_collisions_between_bodies(const RID &p_joint, bool p_disable) {
+	COMMAND_QUEUE_CHECK(_joint_disable_collisions_between_bodies, p_joint, p_disable);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND(!joint);
 	return joint->set_disable_collisions(p_disable);
 }
 bool PhysicsServerBox2D::_joint_is_disabled_collisions_between_bodies(const RID &p_joint) const {
+	SYNC_STEP_CHECK();
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND_V(!joint, false);
 	return joint->get_disable_collisions();
 }
 void PhysicsServerBox2D::_joint_make_pin(const RID &p_joint, const Vector2 &p_anchor, const RID &p_body_a, const RID &p_body_b) {
+	COMMAND_QUEUE_CHECK(_joint_make_pin, p_joint, p_anchor, p_body_a, p_body_b);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	Box2DBody *body_a = body_owner.get_or_null(p_body_a);
 	Box2DBody *body_b = body_owner.get_or_null(p_body_b);
@@ -1016,6 +1150,7 @@ void PhysicsServerBox2D::_joint_make_pin(const RID &p_joint, const Vector2 &p_an
 }
 
 void PhysicsServerBox2D::_joint_make_groove(const RID &p_joint, const Vector2 &p_a_groove1, const Vector2 &p_a_groove2, const Vector2 &p_b_anchor, const RID &p_body_a, const RID &p_body_b) {
+	COMMAND_QUEUE_CHECK(_joint_make_groove, p_joint, p_a_groove1, p_a_groove2, p_b_anchor, p_body_a, p_body_b);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	Box2DBody *body_a = body_owner.get_or_null(p_body_a);
 	Box2DBody *body_b = body_owner.get_or_null(p_body_b);
@@ -1031,6 +1166,7 @@ void PhysicsServerBox2D::_joint_make_groove(const RID &p_joint, const Vector2 &p
 	space->create_joint(joint);
 }
 void PhysicsServerBox2D::_joint_make_damped_spring(const RID &p_joint, const Vector2 &p_anchor_a, const Vector2 &p_anchor_b, const RID &p_body_a, const RID &p_body_b) {
+	COMMAND_QUEUE_CHECK(_joint_make_damped_spring, p_joint, p_anchor_a, p_anchor_b, p_body_a, p_body_b);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	Box2DBody *body_a = body_owner.get_or_null(p_body_a);
 	Box2DBody *body_b = body_owner.get_or_null(p_body_b);
@@ -1046,6 +1182,7 @@ void PhysicsServerBox2D::_joint_make_damped_spring(const RID &p_joint, const Vec
 	space->create_joint(joint);
 }
 void PhysicsServerBox2D::_pin_joint_set_param(const RID &p_joint, PhysicsServer2D::PinJointParam p_param, double p_value) {
+	COMMAND_QUEUE_CHECK(_pin_joint_set_param, p_joint, p_param, p_value);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND(!joint);
 	switch (p_param) {
@@ -1055,6 +1192,7 @@ void PhysicsServerBox2D::_pin_joint_set_param(const RID &p_joint, PhysicsServer2
 	}
 }
 double PhysicsServerBox2D::_pin_joint_get_param(const RID &p_joint, PhysicsServer2D::PinJointParam p_param) const {
+	SYNC_STEP_CHECK();
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND_V(!joint, 0);
 	switch (p_param) {
@@ -1065,6 +1203,7 @@ double PhysicsServerBox2D::_pin_joint_get_param(const RID &p_joint, PhysicsServe
 	return 0;
 }
 void PhysicsServerBox2D::_damped_spring_joint_set_param(const RID &p_joint, PhysicsServer2D::DampedSpringParam p_param, double p_value) {
+	COMMAND_QUEUE_CHECK(_damped_spring_joint_set_param, p_joint, p_param, p_value);
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND(!joint);
 	switch (p_param) {
@@ -1080,6 +1219,7 @@ void PhysicsServerBox2D::_damped_spring_joint_set_param(const RID &p_joint, Phys
 	}
 }
 double PhysicsServerBox2D::_damped_spring_joint_get_param(const RID &p_joint, PhysicsServer2D::DampedSpringParam p_param) const {
+	SYNC_STEP_CHECK();
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND_V(!joint, 0);
 	switch (p_param) {
@@ -1096,6 +1236,7 @@ double PhysicsServerBox2D::_damped_spring_joint_get_param(const RID &p_joint, Ph
 	return 0;
 }
 PhysicsServer2D::JointType PhysicsServerBox2D::_joint_get_type(const RID &p_joint) const {
+	SYNC_STEP_CHECK();
 	Box2DJoint *joint = joint_owner.get_or_null(p_joint);
 	ERR_FAIL_COND_V(!joint, PhysicsServer2D::JointType::JOINT_TYPE_PIN);
 	return joint->get_type();
@@ -1104,25 +1245,29 @@ PhysicsServer2D::JointType PhysicsServerBox2D::_joint_get_type(const RID &p_join
 /* MISC */
 
 void PhysicsServerBox2D::_free_rid(const RID &p_rid) {
+	COMMAND_QUEUE_CHECK(_free_rid, p_rid);
 	if (shape_owner.owns(p_rid)) {
 		Box2DShape *shape = shape_owner.get_or_null(p_rid);
 
-		// TODO: remove from owners?
+		while (shape->get_owners().size()) {
+			Box2DCollisionObject *owner = shape->get_owners().begin()->key;
+			owner->remove_shape(shape);
+		}
 
 		shape_owner.free(p_rid);
-		memdelete(shape);
+		_free_shape(shape);
 	} else if (area_owner.owns(p_rid)) {
 		Box2DArea *area = area_owner.get_or_null(p_rid);
 		area_set_space(p_rid, RID());
 		area_clear_shapes(p_rid);
 		area_owner.free(p_rid);
-		memdelete(area);
+		area_pool.free(area);
 	} else if (body_owner.owns(p_rid)) {
 		Box2DBody *body = body_owner.get_or_null(p_rid);
 		body_set_space(p_rid, RID());
 		body_clear_shapes(p_rid);
 		body_owner.free(p_rid);
-		memdelete(body);
+		body_pool.free(body);
 	} else if (space_owner.owns(p_rid)) {
 		Box2DSpace *space = space_owner.get_or_null(p_rid);
 		// TODO: handle objects, area
@@ -1132,7 +1277,39 @@ void PhysicsServerBox2D::_free_rid(const RID &p_rid) {
 	} else if (joint_owner.owns(p_rid)) {
 		Box2DJoint *joint = joint_owner.get_or_null(p_rid);
 		joint_owner.free(p_rid);
-		memdelete(joint);
+		joint_pool.free(joint);
+	}
+}
+
+void PhysicsServerBox2D::_free_shape(Box2DShape *p_shape) {
+	switch (p_shape->get_type()) {
+		case SHAPE_CIRCLE: {
+			circle_shape_pool.free((Box2DShapeCircle *)p_shape);
+		} break;
+		case SHAPE_RECTANGLE: {
+			rectangle_shape_pool.free((Box2DShapeRectangle *)p_shape);
+		} break;
+		case SHAPE_CAPSULE: {
+			capsule_shape_pool.free((Box2DShapeCapsule *)p_shape);
+		} break;
+		case SHAPE_CONVEX_POLYGON: {
+			convex_polygon_shape_pool.free((Box2DShapeConvexPolygon *)p_shape);
+		} break;
+		case SHAPE_CONCAVE_POLYGON: {
+			concave_polygon_shape_pool.free((Box2DShapeConcavePolygon *)p_shape);
+		} break;
+		case SHAPE_SEGMENT: {
+			segment_shape_pool.free((Box2DShapeSegment *)p_shape);
+		} break;
+		case SHAPE_WORLD_BOUNDARY: {
+			world_boundary_shape_pool.free((Box2DShapeWorldBoundary *)p_shape);
+		} break;
+		case SHAPE_SEPARATION_RAY: {
+			separation_ray_shape_pool.free((Box2DShapeSeparationRay *)p_shape);
+		} break;
+		default: {
+			ERR_FAIL_MSG("Unsupported shape type.");
+		}
 	}
 }
 
@@ -1141,20 +1318,95 @@ void PhysicsServerBox2D::_set_active(bool p_active) {
 }
 
 void PhysicsServerBox2D::_init() {
+	is_main_thread = true;
+	ProjectSettings *project_settings = ProjectSettings::get_singleton();
+	if (project_settings->has_setting("physics/2d/box2d/space_step_thread_count")) {
+		set_space_step_thread_count(project_settings->get_setting("physics/2d/box2d/space_step_thread_count"));
+	}
+	using_threads = project_settings->get_setting("physics/2d/run_on_separate_thread");
+	if (using_threads) {
+		exit_step_thread = false;
+		step_semaphore.instantiate();
+		step_done_semaphore.instantiate();
+		step_thread.instantiate();
+		step_thread->start(callable_mp(this, &PhysicsServerBox2D::_step_thread_loop), Thread::PRIORITY_HIGH);
+	}
+}
+
+void PhysicsServerBox2D::_step_space_task(int32_t p_index) {
+	stepping_spaces[p_index]->step(stepping_delta);
+}
+
+void PhysicsServerBox2D::_step_spaces() {
+	int32_t space_count = stepping_spaces.size();
+	if (space_step_thread_count > 1 && space_count > 1) {
+		WorkerThreadPool *thread_pool = WorkerThreadPool::get_singleton();
+		int64_t group_id = thread_pool->add_group_task(step_space_task, space_count, MIN(space_step_thread_count, space_count), true, "Box2D step spaces");
+		thread_pool->wait_for_group_task_completion(group_id);
+	} else {
+		for (Box2DSpace *space : stepping_spaces) {
+			space->step(stepping_delta);
+		}
+	}
+}
+
+void PhysicsServerBox2D::_step_thread_loop() {
+	while (true) {
+		step_semaphore->wait();
+		if (exit_step_thread) {
+			break;
+		}
+		_step_spaces();
+		step_done_semaphore->post();
+	}
+}
+
+void PhysicsServerBox2D::_apply_area_memberships() {
+	for (Box2DSpace *space : stepping_spaces) {
+		space->apply_area_memberships();
+	}
+}
+
+void PhysicsServerBox2D::_wait_for_step() {
+	ERR_FAIL_COND_MSG(!is_main_thread, "Only the main thread can wait for the physics step.");
+	if (step_in_progress.is_set()) {
+		step_done_semaphore->wait();
+		step_in_progress.clear();
+		_apply_area_memberships();
+	}
+	command_queue.flush();
 }
 
 void PhysicsServerBox2D::_step(double p_step) {
 	if (!active) {
 		return;
 	}
-	// TODO: _update_shapes();
+	_wait_for_step();
 
+	stepping_spaces.clear();
 	for (const Box2DSpace *E : active_spaces) {
 		Box2DSpace *space = const_cast<Box2DSpace *>(E);
-		space->step((float)p_step);
+		// nothing steps or reads the snapshots right now
+		space->compact_if_due();
+		// building fixtures reads the prepared shapes, which spaces share, so it can't run in the parallel step
+		space->flush_pending_updates();
+		stepping_spaces.push_back(space);
+	}
+	stepping_delta = (float)p_step;
+	if (step_space_task.is_null()) {
+		step_space_task = callable_mp(this, &PhysicsServerBox2D::_step_space_task);
+	}
+
+	if (using_threads) {
+		step_in_progress.set();
+		step_semaphore->post();
+	} else {
+		_step_spaces();
+		_apply_area_memberships();
 	}
 }
 void PhysicsServerBox2D::_sync() {
+	_wait_for_step();
 	doing_sync = true;
 }
 
@@ -1177,12 +1429,21 @@ void PhysicsServerBox2D::_end_sync() {
 	doing_sync = false;
 }
 void PhysicsServerBox2D::_finish() {
+	if (step_thread.is_valid()) {
+		_wait_for_step();
+		exit_step_thread = true;
+		step_semaphore->post();
+		step_thread->wait_to_finish();
+		step_thread.unref();
+	}
+	command_queue.flush();
 }
 bool PhysicsServerBox2D::_is_flushing_queries() const {
 	return flushing_queries;
 }
 
 int PhysicsServerBox2D::_get_process_info(ProcessInfo process_info) {
+	SYNC_STEP_CHECK();
 	switch (process_info) {
 		case INFO_ACTIVE_OBJECTS: {
 			int active_body_count = 0;
@@ -1212,6 +1473,69 @@ int PhysicsServerBox2D::_get_process_info(ProcessInfo process_info) {
 	return 0;
 }
 
+void PhysicsServerBox2D::set_space_step_thread_count(int32_t p_thread_count) {
+	if (p_thread_count <= 0) {
+		// use every core
+		p_thread_count = OS::get_singleton()->get_processor_count();
+	}
+	space_step_thread_count = p_thread_count;
+}
+
+int32_t PhysicsServerBox2D::get_space_step_thread_count() const {
+	return space_step_thread_count;
+}
+
+Dictionary PhysicsServerBox2D::get_pool_statistics() const {
+	Dictionary statistics;
+	statistics["body"] = body_pool.get_statistics();
+	statistics["area"] = area_pool.get_statistics();
+	statistics["joint"] = joint_pool.get_statistics();
+	statistics["shape_circle"] = circle_shape_pool.get_statistics();
+	statistics["shape_rectangle"] = rectangle_shape_pool.get_statistics();
+	statistics["shape_capsule"] = capsule_shape_pool.get_statistics();
+	statistics["shape_convex_polygon"] = convex_polygon_shape_pool.get_statistics();
+	statistics["shape_concave_polygon"] = concave_polygon_shape_pool.get_statistics();
+	statistics["shape_segment"] = segment_shape_pool.get_statistics();
+	statistics["shape_world_boundary"] = world_boundary_shape_pool.get_statistics();
+	statistics["shape_separation_ray"] = separation_ray_shape_pool.get_statistics();
+	return statistics;
+}
+
+Dictionary PhysicsServerBox2D::get_space_memory_statistics(const RID &p_space) const {
+	SYNC_STEP_CHECK();
+	const Box2DSpace *space = space_owner.get_or_null(p_space);
+	ERR_FAIL_COND_V(!space, Dictionary());
+	return space->get_memory_statistics();
+}
+
+int64_t PhysicsServerBox2D::get_space_compaction_moved_count(const RID &p_space) const {
+	const Box2DSpace *space = space_owner.get_or_null(p_space);
+	ERR_FAIL_COND_V(!space, 0);
+	return space->get_compaction_moved_count();
+}
+
+int64_t PhysicsServerBox2D::get_object_memory_footprint(const RID &p_object) const {
+	if (body_owner.owns(p_object)) {
+		return body_owner.get_or_null(p_object)->get_memory_footprint();
+	} else if (area_owner.owns(p_object)) {
+		return area_owner.get_or_null(p_object)->get_memory_footprint();
+	}
+	ERR_FAIL_V_MSG(0, "RID is not a body or an area.");
+}
+
+void PhysicsServerBox2D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_space_step_thread_count", "thread_count"), &PhysicsServerBox2D::set_space_step_thread_count);
+	ClassDB::bind_method(D_METHOD("get_space_step_thread_count"), &PhysicsServerBox2D::get_space_step_thread_count);
+	ClassDB::bind_method(D_METHOD("get_object_memory_footprint", "object"), &PhysicsServerBox2D::get_object_memory_footprint);
+	ClassDB::bind_method(D_METHOD("get_pool_statistics"), &PhysicsServerBox2D::get_pool_statistics);
+	ClassDB::bind_method(D_METHOD("get_space_memory_statistics", "space"), &PhysicsServerBox2D::get_space_memory_statistics);
+
+	ClassDB::bind_method(D_METHOD("get_space_compaction_moved_count", "space"), &PhysicsServerBox2D::get_space_compaction_moved_count);
+
+	BIND_CONSTANT(SPACE_PARAM_SUBSTEPS);
+	BIND_CONSTANT(SPACE_PARAM_COMPACTION_INTERVAL);
+}
+
 PhysicsServerBox2D::PhysicsServerBox2D() {
 	default_area.set_priority(-1);
 	default_area.set_gravity_override_mode(AreaSpaceOverrideMode::AREA_SPACE_OVERRIDE_COMBINE);
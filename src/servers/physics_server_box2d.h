@@ -11,18 +11,33 @@
 #include <godot_cpp/classes/physics_server2d.hpp>
 #include <godot_cpp/classes/physics_server2d_extension.hpp>
 #include <godot_cpp/classes/physics_server2d_extension_motion_result.hpp>
+#include <godot_cpp/classes/semaphore.hpp>
+#include <godot_cpp/classes/thread.hpp>
 #include <godot_cpp/variant/callable.hpp>
 
 #include <godot_cpp/core/binder_common.hpp>
 
 #include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/templates/rid_owner.hpp>
+#include <godot_cpp/templates/safe_refcount.hpp>
 
 #include "../bodies/box2d_area.h"
 #include "../bodies/box2d_body.h"
 #include "../joints/box2d_joint.h"
 #include "../shapes/box2d_shape.h"
+#include "../shapes/box2d_shape_capsule.h"
+#include "../shapes/box2d_shape_circle.h"
+#include "../shapes/box2d_shape_concave_polygon.h"
+#include "../shapes/box2d_shape_convex_polygon.h"
+#include "../shapes/box2d_shape_rectangle.h"
+#include "../shapes/box2d_shape_segment.h"
+#include "../shapes/box2d_shape_separation_ray.h"
+#include "../shapes/box2d_shape_world_boundary.h"
 #include "../spaces/box2d_space.h"
+#include "box2d_command_queue.h"
+#include "box2d_object_pool.h"
+#include "box2d_rid_owner.h"
 
 using namespace godot;
 
@@ -36,20 +51,74 @@ class PhysicsServerBox2D : public PhysicsServer2DExtension {
 	bool flushing_queries = false;
 
 	HashSet<const Box2DSpace *> active_spaces;
+
+	// A step only touches state of its own space, so spaces can be stepped on the WorkerThreadPool.
+	// Shapes and their prepared b2Shapes are shared between spaces, pending fixture updates that use them
+	// are applied on the calling thread before the step starts.
+	// With a thread count of 1 they are stepped one after the other on the calling thread.
+	int32_t space_step_thread_count = 1;
+	LocalVector<Box2DSpace *> stepping_spaces;
+	float stepping_delta = 0;
+	Callable step_space_task;
+
+	void _step_space_task(int32_t p_index);
+	void _step_spaces();
+	// bodies enter and leave areas on the main thread right after the step, before any queries
+	void _apply_area_memberships();
+
+	// With run_on_separate_thread the step runs on its own thread from _step until the next _sync.
+	// Calls changing state in the meantime are recorded and applied once the step is done,
+	// calls reading state wait for the step to finish. Calls changing state from other threads are
+	// always recorded, only the main thread applies them.
+	Ref<Thread> step_thread;
+	Ref<Semaphore> step_semaphore;
+	Ref<Semaphore> step_done_semaphore;
+	// read by calls from any thread, e.g. shapes set up by resource loader threads
+	SafeFlag step_in_progress;
+	bool exit_step_thread = false;
+	Box2DCommandQueue command_queue;
+
+	void _step_thread_loop();
+	void _wait_for_step();
+
+	// Objects are pooled, so spawning and freeing many of them recycles memory instead of allocating.
+	Box2DObjectPool<Box2DBody> body_pool;
+	Box2DObjectPool<Box2DArea> area_pool;
+	Box2DObjectPool<Box2DJoint> joint_pool;
+	Box2DObjectPool<Box2DShapeCircle> circle_shape_pool;
+	Box2DObjectPool<Box2DShapeRectangle> rectangle_shape_pool;
+	Box2DObjectPool<Box2DShapeCapsule> capsule_shape_pool;
+	Box2DObjectPool<Box2DShapeConvexPolygon> convex_polygon_shape_pool;
+	Box2DObjectPool<Box2DShapeConcavePolygon> concave_polygon_shape_pool;
+	Box2DObjectPool<Box2DShapeSegment> segment_shape_pool;
+	Box2DObjectPool<Box2DShapeWorldBoundary> world_boundary_shape_pool;
+	Box2DObjectPool<Box2DShapeSeparationRay> separation_ray_shape_pool;
+	// declared after the pools, so it unlinks from bodies leaked at exit before their memory is released
 	Box2DArea default_area;
 
-	mutable RID_PtrOwner<Box2DShape, true> shape_owner;
-	mutable RID_PtrOwner<Box2DSpace, true> space_owner;
-	mutable RID_PtrOwner<Box2DArea, true> area_owner;
-	mutable RID_PtrOwner<Box2DBody, true> body_owner;
-	mutable RID_PtrOwner<Box2DJoint, true> joint_owner;
+	void _free_shape(Box2DShape *p_shape);
+
+	// Every server call resolves a RID, lookups don't lock.
+	mutable Box2DRIDOwner<Box2DShape> shape_owner;
+	mutable Box2DRIDOwner<Box2DSpace> space_owner;
+	mutable Box2DRIDOwner<Box2DArea> area_owner;
+	mutable Box2DRIDOwner<Box2DBody> body_owner;
+	mutable Box2DRIDOwner<Box2DJoint> joint_owner;
 
 	RID _shape_create(ShapeType p_shape);
 
 protected:
-	static void _bind_methods(){};
+	static void _bind_methods();
 
 public:
+	// Space parameters on top of PhysicsServer2D::SpaceParameter, pass them to space_set_param as integers.
+	enum SpaceParameterBox2D {
+		// Number of substeps per step, solver iterations are divided among them. 1 is the classic solver.
+		SPACE_PARAM_SUBSTEPS = 1000,
+		// Steps between re-sorting the body slots of the space by position, 0 disables it.
+		SPACE_PARAM_COMPACTION_INTERVAL = 1001,
+	};
+
 	/* SHAPE API */
 	virtual RID _world_boundary_shape_create() override;
 	virtual RID _separation_ray_shape_create() override;
@@ -198,6 +267,14 @@ public:
 	virtual bool _is_flushing_queries() const override;
 	virtual int32_t _get_process_info(PhysicsServer2D::ProcessInfo process_info) override;
 
+	void set_space_step_thread_count(int32_t p_thread_count);
+	int32_t get_space_step_thread_count() const;
+
+	int64_t get_object_memory_footprint(const RID &p_object) const;
+	Dictionary get_pool_statistics() const;
+	Dictionary get_space_memory_statistics(const RID &p_space) const;
+	int64_t get_space_compaction_moved_count(const RID &p_space) const;
+
 	PhysicsServerBox2D();
 	~PhysicsServerBox2D();
 };
@@ -1,6 +1,7 @@
 #include "box2d_shape.h"
 #include "bodies/box2d_collision_object.h"
 #include "box2d_type_conversions.h"
+#include "spaces/box2d_space_allocator.h"
 
 #include <godot_cpp/core/memory.hpp>
 
@@ -8,3 +9,73 @@
 #include <box2d/b2_circle_shape.h>
 #include <box2d/b2_edge_shape.h>
 #include <box2d/b2_polygon_shape.h>
+
+const LocalVector<b2Shape *> &Box2DShape::get_prepared_b2Shapes(const Transform2D &p_transform, bool one_way, bool is_static) {
+	for (const PreparedShapes &prepared : prepared_shapes) {
+		if (prepared.one_way == one_way && prepared.is_static == is_static && prepared.transform == p_transform) {
+			return prepared.shapes;
+		}
+	}
+	if (prepared_shapes.size() == MAX_PREPARED_SHAPES) {
+		// placements that keep changing, drop the oldest one
+		for (b2Shape *shape : prepared_shapes[0].shapes) {
+			if (shape) {
+				memdelete(shape);
+			}
+		}
+		prepared_shapes.remove_at(0);
+	}
+	// the shapes outlive any space, so their buffers (e.g. chain vertices) can't come from a space allocator
+	Box2DSpaceAllocator::Scope allocator_scope(nullptr);
+	PreparedShapes prepared;
+	prepared.transform = p_transform;
+	prepared.one_way = one_way;
+	prepared.is_static = is_static;
+	int shape_count = get_b2Shape_count(is_static);
+	prepared.shapes.resize(shape_count);
+	for (int i = 0; i < shape_count; i++) {
+		prepared.shapes[i] = get_transformed_b2Shape(i, p_transform, one_way, is_static);
+	}
+	prepared_shapes.push_back(prepared);
+	return prepared_shapes[prepared_shapes.size() - 1].shapes;
+}
+
+void Box2DShape::clear_prepared_b2Shapes() {
+	for (const PreparedShapes &prepared : prepared_shapes) {
+		for (b2Shape *shape : prepared.shapes) {
+			if (shape) {
+				memdelete(shape);
+			}
+		}
+	}
+	prepared_shapes.clear();
+}
+
+void Box2DShape::data_changed() {
+	clear_prepared_b2Shapes();
+	for (const KeyValue<Box2DCollisionObject *, int> &E : owners) {
+		E.key->shape_changed(this);
+	}
+}
+
+void Box2DShape::add_owner(Box2DCollisionObject *p_owner) {
+	HashMap<Box2DCollisionObject *, int>::Iterator E = owners.find(p_owner);
+	if (E) {
+		E->value++;
+	} else {
+		owners[p_owner] = 1;
+	}
+}
+
+void Box2DShape::remove_owner(Box2DCollisionObject *p_owner) {
+	HashMap<Box2DCollisionObject *, int>::Iterator E = owners.find(p_owner);
+	ERR_FAIL_COND(!E);
+	E->value--;
+	if (E->value == 0) {
+		owners.remove(E);
+	}
+}
+
+Box2DShape::~Box2DShape() {
+	clear_prepared_b2Shapes();
+}
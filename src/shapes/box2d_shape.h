@@ -2,6 +2,8 @@
 
 #include <godot_cpp/classes/physics_server2d.hpp>
 #include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/rid.hpp>
 #include <godot_cpp/variant/variant.hpp>
@@ -15,6 +17,19 @@ class Box2DCollisionObject;
 
 class Box2DShape {
 	RID self;
+	// objects using this shape, with the number of their shape slots that do
+	HashMap<Box2DCollisionObject *, int> owners;
+
+	// Box2D shapes already built for one placement of this shape. Fixtures copy their shape,
+	// so these are only read when creating fixtures and every object with the same placement shares them.
+	struct PreparedShapes {
+		Transform2D transform;
+		bool one_way = false;
+		bool is_static = false;
+		LocalVector<b2Shape *> shapes;
+	};
+	static constexpr uint32_t MAX_PREPARED_SHAPES = 8;
+	LocalVector<PreparedShapes> prepared_shapes; // oldest first
 
 protected:
 	bool configured = false;
@@ -32,7 +47,17 @@ public:
 
 	virtual int get_b2Shape_count(bool is_static) const = 0;
 	virtual b2Shape *get_transformed_b2Shape(int p_index, const Transform2D &p_transform, bool one_way, bool is_static) = 0;
+	// Returns the Box2D shapes for this placement, building them on first use. Entries are null for shapes that failed to build.
+	// Only valid until the next call.
+	const LocalVector<b2Shape *> &get_prepared_b2Shapes(const Transform2D &p_transform, bool one_way, bool is_static);
+	void clear_prepared_b2Shapes();
+	// Must be called after set_data, drops the prepared shapes and has the owners rebuild their fixtures.
+	void data_changed();
+
+	void add_owner(Box2DCollisionObject *p_owner);
+	void remove_owner(Box2DCollisionObject *p_owner);
+	_FORCE_INLINE_ const HashMap<Box2DCollisionObject *, int> &get_owners() const { return owners; }
 
 	Box2DShape() { type = PhysicsServer2D::SHAPE_CUSTOM; }
-	virtual ~Box2DShape(){};
+	virtual ~Box2DShape();
 };
@@ -3,6 +3,7 @@
 
 #include "box2d_shape_convex_polygon.h"
 
+#include <godot_cpp/classes/geometry2d.hpp>
 #include <godot_cpp/core/memory.hpp>
 
 #include <box2d/b2_chain_shape.h>
@@ -18,6 +19,28 @@ void Box2DShapeConcavePolygon::set_data(const Variant &p_data) {
 	}
 	points = Box2DShapeConvexPolygon::remove_points_that_are_too_close(points);
 	ERR_FAIL_COND(points.size() < 3);
+
+	// Non static bodies can't use a chain, decompose into as few convex pieces as possible once here
+	// instead of a fixture per edge.
+	convex_pieces.clear();
+	PackedVector2Array polygon;
+	polygon.resize(points.size());
+	for (int i = 0; i < points.size(); i++) {
+		polygon[i] = points[i];
+	}
+	TypedArray<PackedVector2Array> decomposed = Geometry2D::get_singleton()->decompose_polygon_in_convex(polygon);
+	for (int i = 0; i < decomposed.size(); i++) {
+		PackedVector2Array decomposed_piece = decomposed[i];
+		Vector<Vector2> piece;
+		piece.resize(decomposed_piece.size());
+		for (int j = 0; j < decomposed_piece.size(); j++) {
+			piece.write[j] = decomposed_piece[j];
+		}
+		convex_pieces.append_array(Box2DShapeConvexPolygon::split_convex(piece));
+	}
+	if (convex_pieces.is_empty()) {
+		WARN_PRINT("Concave polygon couldn't be decomposed, using a fixture per edge.");
+	}
 	configured = true;
 }
 
@@ -33,6 +56,9 @@ int Box2DShapeConcavePolygon::get_b2Shape_count(bool is_static) const {
 	if (is_static) {
 		return 1;
 	}
+	if (!convex_pieces.is_empty()) {
+		return convex_pieces.size();
+	}
 	return points.size();
 }
 
@@ -40,18 +66,35 @@ b2Shape *Box2DShapeConcavePolygon::get_transformed_b2Shape(int p_index, const Tr
 	// make a chain shape if it's static
 	if (is_static) {
 		ERR_FAIL_INDEX_V(p_index, 1, nullptr);
-		b2ChainShape *shape = memnew(b2ChainShape);
 		b2Vec2 *box2d_points = new b2Vec2[points.size()];
 		for (int i = 0; i < points.size(); i++) {
 			godot_to_box2d(p_transform.xform(points[i]), box2d_points[i]);
 		}
 		int points_count = points.size();
 		points_count = Box2DShapeConvexPolygon::remove_bad_points(box2d_points, points_count);
-		ERR_FAIL_COND_V(points_count < 3, nullptr);
-		shape->CreateChain(box2d_points, points_count, box2d_points[points.size() - 1], box2d_points[0]);
+		if (points_count < 3) {
+			delete[] box2d_points;
+			ERR_FAIL_V(nullptr);
+		}
+		b2ChainShape *shape = memnew(b2ChainShape);
+		shape->CreateChain(box2d_points, points_count, box2d_points[points_count - 1], box2d_points[0]);
 		delete[] box2d_points;
 		return shape;
 	}
+	if (!convex_pieces.is_empty()) {
+		ERR_FAIL_INDEX_V(p_index, convex_pieces.size(), nullptr);
+		const Vector<Vector2> &piece = convex_pieces[p_index];
+		b2Vec2 box2d_points[b2_maxPolygonVertices];
+		for (int i = 0; i < piece.size(); i++) {
+			godot_to_box2d(p_transform.xform(piece[i]), box2d_points[i]);
+		}
+		// the transform may scale the piece down until points merge
+		int new_size = Box2DShapeConvexPolygon::remove_bad_points(box2d_points, piece.size());
+		ERR_FAIL_COND_V(new_size < 3, nullptr);
+		b2PolygonShape *shape = memnew(b2PolygonShape);
+		shape->Set(box2d_points, new_size);
+		return shape;
+	}
 	ERR_FAIL_COND_V(p_index > points.size(), nullptr);
 	// if not make multiple small squares the size of a line
 	b2PolygonShape *shape = memnew(b2PolygonShape);
@@ -3,6 +3,8 @@
 
 class Box2DShapeConcavePolygon : public Box2DShape {
 	Vector<Vector2> points;
+	// convex decomposition used for non static bodies, empty if the polygon couldn't be decomposed
+	Vector<Vector<Vector2>> convex_pieces;
 
 public:
 	virtual void set_data(const Variant &p_data) override;
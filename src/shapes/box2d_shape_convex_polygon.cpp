@@ -1,6 +1,7 @@
 #include "box2d_shape_convex_polygon.h"
 #include "../box2d_type_conversions.h"
 
+#include <godot_cpp/classes/geometry2d.hpp>
 #include <godot_cpp/core/memory.hpp>
 
 #include <box2d/b2_chain_shape.h>
@@ -17,24 +18,23 @@ void Box2DShapeConvexPolygon::set_data(const Variant &p_data) {
 
 	points = remove_points_that_are_too_close(points);
 	ERR_FAIL_COND(points.size() < 3);
-	polygons.clear();
-	int cut_polygon_size = 0;
-	// Cut convex into small N<=8 gons
-	for (int i = 0; i < points.size(); i += cut_polygon_size) {
-		// check how big we should make the polygon with remaining points
-		cut_polygon_size = std::min(b2_maxPolygonVertices, points.size() - i);
-		int remaining_count = points.size() - (i + cut_polygon_size);
-		// if after this we have less than 4 points remaining, make a smaller polygon
-		if (remaining_count <= 4 && remaining_count != 0) {
-			cut_polygon_size -= 4;
-		}
-		Vector<Vector2> cut_polygon;
-		cut_polygon.resize(cut_polygon_size);
-		for (int j = 0; j < cut_polygon_size; j++) {
-			cut_polygon.write[j] = points[i + j];
-		}
-		polygons.append(cut_polygon);
+
+	// Split the hull once here into a fan of N<=8 gons, (N - 2) / 6 rounded up of them.
+	PackedVector2Array welded_points;
+	welded_points.resize(points.size());
+	for (int i = 0; i < points.size(); i++) {
+		welded_points[i] = points[i];
 	}
+	PackedVector2Array hull = Geometry2D::get_singleton()->convex_hull(welded_points);
+	Vector<Vector2> hull_points;
+	hull_points.resize(hull.size());
+	for (int i = 0; i < hull.size(); i++) {
+		hull_points.write[i] = hull[i];
+	}
+	// the hull repeats its first point at the end
+	hull_points = remove_points_that_are_too_close(hull_points);
+	polygons = split_convex(hull_points);
+	ERR_FAIL_COND(polygons.is_empty());
 	configured = true;
 }
 
@@ -74,6 +74,34 @@ Vector<Vector2> Box2DShapeConvexPolygon::remove_points_that_are_too_close(Vector
 	return new_points;
 }
 
+Vector<Vector<Vector2>> Box2DShapeConvexPolygon::split_convex(const Vector<Vector2> &p_points) {
+	Vector<Vector<Vector2>> pieces;
+	int point_count = p_points.size();
+	// every piece after the first starts at the last point of the previous one
+	for (int first = 1; first < point_count - 1; first += b2_maxPolygonVertices - 2) {
+		int last = MIN(first + b2_maxPolygonVertices - 2, point_count - 1);
+		Vector<Vector2> piece;
+		piece.push_back(p_points[0]);
+		for (int i = first; i <= last; i++) {
+			piece.push_back(p_points[i]);
+		}
+		piece = remove_points_that_are_too_close(piece);
+		if (piece.size() < 3) {
+			continue;
+		}
+		// collinear points would make b2PolygonShape::Set fall back to a unit box
+		real_t doubled_area = 0;
+		for (int i = 0; i < piece.size(); i++) {
+			doubled_area += piece[i].cross(piece[(i + 1) % piece.size()]);
+		}
+		if (Math::abs(doubled_area) < GODOT_LINEAR_SLOP * GODOT_LINEAR_SLOP) {
+			continue;
+		}
+		pieces.push_back(piece);
+	}
+	return pieces;
+}
+
 // based on https://github.com/briansemrau/godot_box2d/blob/5f55923fac81386e5735573e99d908d18efec6a1/scene/resources/box2d_shapes.cpp#L424
 int Box2DShapeConvexPolygon::remove_bad_points(b2Vec2 *vertices, int32 count) {
 	int32 n = b2Min(count, b2_maxPolygonVertices);
@@ -176,12 +204,13 @@ b2Shape *Box2DShapeConvexPolygon::get_transformed_b2Shape(int p_index, const Tra
 	ERR_FAIL_COND_V(polygon.size() > b2_maxPolygonVertices, nullptr);
 	ERR_FAIL_COND_V(polygon.size() < 3, nullptr);
 	b2Vec2 b2_points[b2_maxPolygonVertices];
-	b2PolygonShape *polygon_shape = memnew(b2PolygonShape);
 	for (int i = 0; i < polygon.size(); i++) {
 		godot_to_box2d(p_transform.xform(polygon[i]), b2_points[i]);
 	}
+	// a scaled down transform can still weld points together, Set would then fall back to a unit box
 	int new_size = remove_bad_points(b2_points, polygon.size());
 	ERR_FAIL_COND_V(new_size < 3, nullptr);
+	b2PolygonShape *polygon_shape = memnew(b2PolygonShape);
 	polygon_shape->Set(b2_points, new_size);
 	return polygon_shape;
 }
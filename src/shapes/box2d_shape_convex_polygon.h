@@ -8,6 +8,9 @@ class Box2DShapeConvexPolygon : public Box2DShape {
 public:
 	static Vector<Vector2> remove_points_that_are_too_close(Vector<Vector2> points);
 	static int remove_bad_points(b2Vec2 *vertices, int32 count);
+	// Splits a convex polygon into a fan of pieces around its first point, each with at most b2_maxPolygonVertices points.
+	// The pieces share their diagonals, so they cover the polygon exactly. Degenerate pieces are left out.
+	static Vector<Vector<Vector2>> split_convex(const Vector<Vector2> &p_points);
 	virtual void set_data(const Variant &p_data) override;
 	virtual Variant get_data() const override;
 	virtual int get_b2Shape_count(bool is_static) const override;
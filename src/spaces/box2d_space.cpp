@@ -5,6 +5,7 @@
 #include <box2d/b2_body.h>
 #include <box2d/b2_contact.h>
 
+#include "../bodies/box2d_area.h"
 #include "../bodies/box2d_body.h"
 #include "../bodies/box2d_collision_object.h"
 #include "box2d_direct_space_state.h"
@@ -23,27 +24,37 @@ int32_t Box2DSpace::get_collision_pairs() {
 int32_t Box2DSpace::get_island_count() {
 	return 0; // not sure if this is exposed
 }
-int32_t Box2DSpace::get_contact_count() const {
-	int32 contact_count = world->GetContactCount();
-	int32_t contact_total = 0;
-	b2Contact *contacts = world->GetContactList();
-	for (int i = 0; i < contact_count; i++) {
-		contact_total += contacts->GetManifold()->pointCount;
+void Box2DSpace::_update_contact_positions() const {
+	if (contact_positions_version == contacts_version) {
+		return;
+	}
+	contact_positions_version = contacts_version;
+	contact_positions.clear();
+	for (b2Contact *contact = world->GetContactList(); contact; contact = contact->GetNext()) {
+		int32 point_count = contact->GetManifold()->pointCount;
+		if (point_count == 0) {
+			continue;
+		}
+		b2WorldManifold worldManifold;
+		contact->GetWorldManifold(&worldManifold);
+		for (int32 i = 0; i < point_count; i++) {
+			contact_positions.push_back(box2d_to_godot(worldManifold.points[i]));
+		}
 	}
-	return contact_total;
+}
+
+int32_t Box2DSpace::get_contact_count() const {
+	_update_contact_positions();
+	return contact_positions.size();
 }
 
 PackedVector2Array Box2DSpace::get_contacts() const {
+	_update_contact_positions();
 	PackedVector2Array vector_array;
-	int32 contact_count = world->GetContactCount();
-	int32_t contact_total = 0;
-	b2Contact *contacts = world->GetContactList();
-	for (int i = 0; i < contact_count; i++) {
-		b2WorldManifold worldManifold;
-		contacts->GetWorldManifold(&worldManifold);
-		for (int j = 0; j < contacts->GetManifold()->pointCount; j++) {
-			vector_array.append(box2d_to_godot(worldManifold.points[j]));
-		}
+	vector_array.resize(contact_positions.size());
+	Vector2 *positions = vector_array.ptrw();
+	for (uint32_t i = 0; i < contact_positions.size(); i++) {
+		positions[i] = contact_positions[i];
 	}
 	return vector_array;
 }
@@ -59,38 +70,241 @@ int32 Box2DSpace::get_solver_iterations() const {
 	return solver_iterations;
 }
 
+void Box2DSpace::set_substeps(int32 p_substeps) {
+	substeps = MAX(p_substeps, 1);
+}
+
+int32 Box2DSpace::get_substeps() const {
+	return substeps;
+}
+
+void Box2DSpace::set_compaction_interval(int32 p_interval) {
+	compaction_interval = MAX(p_interval, 0);
+}
+
+int32 Box2DSpace::get_compaction_interval() const {
+	return compaction_interval;
+}
+
+static uint32_t _morton_spread(uint32_t p_value) {
+	p_value &= 0x0000ffff;
+	p_value = (p_value | (p_value << 8)) & 0x00ff00ff;
+	p_value = (p_value | (p_value << 4)) & 0x0f0f0f0f;
+	p_value = (p_value | (p_value << 2)) & 0x33333333;
+	p_value = (p_value | (p_value << 1)) & 0x55555555;
+	return p_value;
+}
+
+template <class T>
+void Box2DSpace::_permute_slots(LocalVector<T> &r_array, const LocalVector<uint32_t> &p_order) {
+	LocalVector<T> sorted;
+	sorted.resize(r_array.size());
+	for (uint32_t i = 0; i < p_order.size(); i++) {
+		sorted[i] = r_array[p_order[i]];
+	}
+	r_array = sorted;
+}
+
+void Box2DSpace::_compact_body_slots() {
+	uint32_t slot_count = slot_bodies.size();
+	if (slot_count < 2) {
+		return;
+	}
+	b2AABB bounds;
+	bounds.lowerBound = bounds.upperBound = slot_b2bodies[0]->GetPosition();
+	for (uint32_t i = 1; i < slot_count; i++) {
+		const b2Vec2 &position = slot_b2bodies[i]->GetPosition();
+		bounds.lowerBound = b2Min(bounds.lowerBound, position);
+		bounds.upperBound = b2Max(bounds.upperBound, position);
+	}
+	// quantize to 16 bits per axis
+	b2Vec2 extents = bounds.upperBound - bounds.lowerBound;
+	b2Vec2 scale(extents.x > 0 ? 65535.0f / extents.x : 0, extents.y > 0 ? 65535.0f / extents.y : 0);
+
+	struct MortonSlot {
+		uint32_t key;
+		uint32_t index;
+		bool operator<(const MortonSlot &p_other) const { return key < p_other.key; }
+	};
+	LocalVector<MortonSlot> morton_slots;
+	morton_slots.resize(slot_count);
+	for (uint32_t i = 0; i < slot_count; i++) {
+		b2Vec2 local = slot_b2bodies[i]->GetPosition() - bounds.lowerBound;
+		uint32_t x = (uint32_t)(local.x * scale.x);
+		uint32_t y = (uint32_t)(local.y * scale.y);
+		morton_slots[i] = MortonSlot{ _morton_spread(x) | (_morton_spread(y) << 1), i };
+	}
+	morton_slots.sort();
+
+	LocalVector<uint32_t> order;
+	order.resize(slot_count);
+	uint32_t moved = 0;
+	for (uint32_t i = 0; i < slot_count; i++) {
+		order[i] = morton_slots[i].index;
+		if (order[i] != i) {
+			moved++;
+		}
+	}
+	if (moved == 0) {
+		return;
+	}
+	_permute_slots(slot_bodies, order);
+	_permute_slots(slot_b2bodies, order);
+	_permute_slots(slot_active, order);
+	_permute_slots(slot_gravity_scale, order);
+	_permute_slots(slot_total_gravity, order);
+	_permute_slots(slot_constant_force, order);
+	_permute_slots(slot_constant_force_position, order);
+	_permute_slots(slot_constant_torque, order);
+	_permute_slots(snapshots[0], order);
+	_permute_slots(snapshots[1], order);
+	for (uint32_t i = 0; i < slot_count; i++) {
+		slot_bodies[i]->set_slot_index(i);
+	}
+	compaction_moved_count += moved;
+}
+
+void Box2DSpace::compact_if_due() {
+	if (compaction_interval <= 0 || step_count - last_compaction_step < compaction_interval) {
+		return;
+	}
+	last_compaction_step = step_count;
+	_compact_body_slots();
+}
+
 void Box2DSpace::step(float p_step) {
-	const int32 velocityIterations = solver_iterations;
-	const int32 positionIterations = solver_iterations;
+	// With substeps the iterations are spread over smaller steps.
+	// The remainder goes to the first substeps, so they add up to the solver iterations.
+	const int32 base_iterations = solver_iterations / substeps;
+	const int32 extra_iterations = solver_iterations % substeps;
+	const float substep = p_step / substeps;
+	Box2DSpaceAllocator::Scope allocator_scope(&allocator);
+	const uint64_t alloc_count_before = allocator.get_total_alloc_count();
+
+	_apply_body_forces();
+	for (int32 i = 0; i < substeps; i++) {
+		const int32 substep_iterations = MAX(base_iterations + (i < extra_iterations ? 1 : 0), 1);
+		world->Step(substep, substep_iterations, substep_iterations);
+	}
+	// forces applied before the step act on every substep
+	world->ClearForces();
+	step_count++;
+	contacts_changed();
 
 	const SelfList<Box2DBody>::List *body_list = &get_active_body_list();
 	const SelfList<Box2DBody> *b = body_list->first();
 	while (b) {
-		b->self()->before_step();
+		b->self()->after_step();
 		b = b->next();
 	}
-	world->Step(p_step, velocityIterations, positionIterations);
-	step_count++;
+	_publish_body_snapshots();
+
+	last_step_alloc_count = allocator.get_total_alloc_count() - alloc_count_before;
+#ifdef DEBUG_ENABLED
+	// a step with the same bodies and contacts as the previous one should reuse memory
+	if (last_step_alloc_count > 0 && world->GetBodyCount() == last_body_count && world->GetContactCount() == last_contact_count) {
+		WARN_PRINT_ONCE("Box2D allocated memory during a steady state step.");
+	}
+	last_body_count = world->GetBodyCount();
+	last_contact_count = world->GetContactCount();
+#endif
+}
 
-	body_list = &get_active_body_list();
-	b = body_list->first();
+void Box2DSpace::_apply_body_forces() {
+	for (uint32_t i = 0; i < slot_b2bodies.size(); i++) {
+		if (!slot_active[i]) {
+			continue;
+		}
+		b2Body *body = slot_b2bodies[i];
+		const float mass = body->GetMass();
+		// custom gravity
+		body->ApplyForceToCenter(mass * slot_gravity_scale[i] * slot_total_gravity[i], false);
+		if (slot_constant_force[i] != b2Vec2_zero) {
+			// constant force
+			body->ApplyForce(mass * slot_constant_force[i], slot_constant_force_position[i] + body->GetPosition(), true);
+		}
+		if (slot_constant_torque[i] != 0) {
+			// constant torque
+			body->ApplyTorque(mass * slot_constant_torque[i], true);
+		}
+	}
+}
+
+void Box2DSpace::_write_body_snapshot(const Box2DBody *p_body, BodySnapshot &r_snapshot) const {
+	r_snapshot.transform = p_body->get_transform();
+	r_snapshot.linear_velocity = p_body->get_linear_velocity();
+	r_snapshot.angular_velocity = p_body->get_angular_velocity();
+	r_snapshot.sleeping = !p_body->is_active();
+}
+
+void Box2DSpace::_publish_body_snapshots() {
+	uint32_t back = snapshot_front.get() ^ 1;
+	LocalVector<BodySnapshot> &back_snapshots = snapshots[back];
 	process_info.active_body_count = 0;
-	while (b) {
-		if (!b->self()->is_sleeping()) {
+	for (uint32_t i = 0; i < slot_bodies.size(); i++) {
+		if (slot_active[i] && slot_b2bodies[i]->IsAwake()) {
 			process_info.active_body_count++;
 		}
-		b->self()->after_step();
-		b = b->next();
+		_write_body_snapshot(slot_bodies[i], back_snapshots[i]);
+	}
+	snapshot_front.set(back);
+}
+
+void Box2DSpace::apply_area_memberships() {
+	// Called by the server as soon as the step is done, so area overrides apply from the next step
+	// and queries see the new memberships.
+	for (const AreaMonitorEvent &event : area_monitor_events) {
+		if (!event.area || !event.other || event.other_is_area) {
+			continue;
+		}
+		if (event.status == PhysicsServer2D::AREA_BODY_ADDED) {
+			event.area->add_body(event.other);
+		} else {
+			event.area->remove_body(event.other);
+		}
 	}
 }
 
 void Box2DSpace::call_queries() {
+	// no allocator scope here, callbacks may change other spaces and their calls set their own scopes
 	while (state_query_list.first()) {
 		Box2DBody *b = state_query_list.first()->self();
 		state_query_list.remove(state_query_list.first());
 		b->call_queries();
 	}
-	// TODO: areas
+	// Callbacks may free objects, which clears their events, so index instead of iterating.
+	for (uint32_t i = 0; i < area_monitor_events.size(); i++) {
+		const AreaMonitorEvent event = area_monitor_events[i];
+		if (!event.area) {
+			continue;
+		}
+		if (event.other_is_area) {
+			event.area->call_area_monitor((Box2DArea *)event.other, event.status, event.other_rid, event.other_instance_id, event.other_shape_idx, event.self_shape_idx);
+		} else {
+			event.area->call_monitor(event.other, event.status, event.other_rid, event.other_instance_id, event.other_shape_idx, event.self_shape_idx);
+		}
+	}
+	// keeps the capacity for the next step
+	area_monitor_events.clear();
+}
+
+Dictionary Box2DSpace::get_memory_statistics() const {
+	Dictionary statistics = allocator.get_statistics();
+	statistics["last_step_alloc_count"] = (int64_t)last_step_alloc_count;
+	return statistics;
+}
+
+void Box2DSpace::add_area_monitor_event(Box2DArea *p_area, Box2DCollisionObject *p_other, PhysicsServer2D::AreaBodyStatus p_status, int32_t p_other_shape_idx, int32_t p_self_shape_idx) {
+	AreaMonitorEvent event;
+	event.area = p_area;
+	event.other = p_other;
+	event.other_rid = p_other->get_self();
+	event.other_instance_id = p_other->get_object_instance_id();
+	event.other_shape_idx = p_other_shape_idx;
+	event.self_shape_idx = p_self_shape_idx;
+	event.status = p_status;
+	event.other_is_area = p_other->get_type() == Box2DCollisionObject::TYPE_AREA;
+	area_monitor_events.push_back(event);
 }
 
 Box2DDirectSpaceState *Box2DSpace::get_direct_state() {
@@ -121,15 +335,97 @@ void Box2DSpace::body_add_to_state_query_list(SelfList<Box2DBody> *p_body) {
 void Box2DSpace::body_remove_from_state_query_list(SelfList<Box2DBody> *p_body) {
 	state_query_list.remove(p_body);
 }
+
+void Box2DSpace::object_add_to_pending_update_list(SelfList<Box2DCollisionObject> *p_object) {
+	pending_update_list.add(p_object);
+}
+
+void Box2DSpace::object_remove_from_pending_update_list(SelfList<Box2DCollisionObject> *p_object) {
+	pending_update_list.remove(p_object);
+}
+
+void Box2DSpace::flush_pending_updates() {
+	while (pending_update_list.first()) {
+		Box2DCollisionObject *object = pending_update_list.first()->self();
+		pending_update_list.remove(pending_update_list.first());
+		object->update_pending();
+	}
+}
+
+int32_t Box2DSpace::body_add_slot(Box2DBody *p_body) {
+	ERR_FAIL_COND_V(!p_body->get_b2Body(), -1);
+	BodySnapshot snapshot;
+	_write_body_snapshot(p_body, snapshot);
+	slot_bodies.push_back(p_body);
+	slot_b2bodies.push_back(p_body->get_b2Body());
+	slot_active.push_back(false);
+	slot_gravity_scale.push_back(1);
+	slot_total_gravity.push_back(b2Vec2_zero);
+	slot_constant_force.push_back(b2Vec2_zero);
+	slot_constant_force_position.push_back(b2Vec2_zero);
+	slot_constant_torque.push_back(0);
+	snapshots[0].push_back(snapshot);
+	snapshots[1].push_back(snapshot);
+	return slot_bodies.size() - 1;
+}
+
+void Box2DSpace::body_remove_slot(int32_t p_index) {
+	ERR_FAIL_INDEX(p_index, (int32_t)slot_bodies.size());
+	// swap with the last slot, so the arrays stay packed
+	slot_bodies.remove_at_unordered(p_index);
+	slot_b2bodies.remove_at_unordered(p_index);
+	slot_active.remove_at_unordered(p_index);
+	slot_gravity_scale.remove_at_unordered(p_index);
+	slot_total_gravity.remove_at_unordered(p_index);
+	slot_constant_force.remove_at_unordered(p_index);
+	slot_constant_force_position.remove_at_unordered(p_index);
+	slot_constant_torque.remove_at_unordered(p_index);
+	snapshots[0].remove_at_unordered(p_index);
+	snapshots[1].remove_at_unordered(p_index);
+	if (p_index < (int32_t)slot_bodies.size()) {
+		slot_bodies[p_index]->set_slot_index(p_index);
+	}
+}
+
+void Box2DSpace::body_set_slot_active(int32_t p_index, bool p_active) {
+	ERR_FAIL_INDEX(p_index, (int32_t)slot_bodies.size());
+	slot_active[p_index] = p_active;
+}
+
+void Box2DSpace::body_set_slot_forces(int32_t p_index, real_t p_gravity_scale, const b2Vec2 &p_total_gravity, const b2Vec2 &p_constant_force, const b2Vec2 &p_constant_force_position, real_t p_constant_torque) {
+	ERR_FAIL_INDEX(p_index, (int32_t)slot_bodies.size());
+	slot_gravity_scale[p_index] = p_gravity_scale;
+	slot_total_gravity[p_index] = p_total_gravity;
+	slot_constant_force[p_index] = p_constant_force;
+	slot_constant_force_position[p_index] = p_constant_force_position;
+	slot_constant_torque[p_index] = p_constant_torque;
+}
+
+void Box2DSpace::body_update_snapshot(int32_t p_index) {
+	ERR_FAIL_INDEX(p_index, (int32_t)slot_bodies.size());
+	// only called between steps, when nothing reads or writes the buffers concurrently
+	BodySnapshot &snapshot = snapshots[snapshot_front.get()][p_index];
+	_write_body_snapshot(slot_bodies[p_index], snapshot);
+}
 /* COLLISION OBJECT API */
 void Box2DSpace::add_object(Box2DCollisionObject *p_object) {
 	ERR_FAIL_COND(!p_object);
+	Box2DSpaceAllocator::Scope allocator_scope(&allocator);
 	p_object->set_b2Body(world->CreateBody(p_object->get_b2BodyDef()));
 }
 void Box2DSpace::remove_object(Box2DCollisionObject *p_object) {
 	ERR_FAIL_COND(!p_object);
+	Box2DSpaceAllocator::Scope allocator_scope(&allocator);
 	world->DestroyBody(p_object->get_b2Body());
 	p_object->set_b2Body(nullptr);
+	// Destroying the body reported its last contacts, keep those but drop the pointer.
+	for (AreaMonitorEvent &event : area_monitor_events) {
+		if (event.area == p_object) {
+			event.area = nullptr;
+		} else if (event.other == p_object) {
+			event.other = nullptr;
+		}
+	}
 	for (Box2DJoint *joint : p_object->get_joints()) {
 		joint->set_b2Joint(nullptr); // joint is destroyed when destroying body
 	}
@@ -139,12 +435,14 @@ void Box2DSpace::create_joint(Box2DJoint *joint) {
 	remove_joint(joint);
 	// create joint once and if both body exist
 	if (joint->is_configured()) {
+		Box2DSpaceAllocator::Scope allocator_scope(&allocator);
 		b2JointDef *joint_def = joint->get_b2JointDef();
 		joint->set_b2Joint(world->CreateJoint(joint_def));
 	}
 }
 void Box2DSpace::remove_joint(Box2DJoint *joint) {
 	if (joint->get_b2Joint()) {
+		Box2DSpaceAllocator::Scope allocator_scope(&allocator);
 		world->DestroyJoint(joint->get_b2Joint());
 		joint->set_b2Joint(nullptr);
 	}
@@ -156,7 +454,9 @@ double Box2DSpace::get_step() {
 }
 
 Box2DSpace::Box2DSpace() {
+	Box2DSpaceAllocator::Scope allocator_scope(&allocator);
 	world = memnew(b2World(b2Vec2_zero)); // gravity comes from areas
+	world->SetAutoClearForces(false); // cleared after all substeps
 	contact_filter = memnew(Box2DSpaceContactFilter);
 	contact_listener = memnew(Box2DSpaceContactListener(this));
 	world->SetContactFilter(contact_filter);
@@ -164,7 +464,10 @@ Box2DSpace::Box2DSpace() {
 }
 
 Box2DSpace::~Box2DSpace() {
-	memdelete(world);
+	{
+		Box2DSpaceAllocator::Scope allocator_scope(&allocator);
+		memdelete(world);
+	}
 	memdelete(contact_filter);
 	memdelete(contact_listener);
 	if (direct_state) {
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <godot_cpp/classes/physics_server2d.hpp>
 #include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/safe_refcount.hpp>
 #include <godot_cpp/templates/self_list.hpp>
 #include <godot_cpp/variant/packed_vector2_array.hpp>
 #include <godot_cpp/variant/rid.hpp>
 
 #include <box2d/b2_world.h>
 
+#include "box2d_space_allocator.h"
+
 using namespace godot;
 
 class Box2DCollisionObject;
@@ -18,24 +23,96 @@ class Box2DSpaceContactListener;
 class Box2DArea;
 
 class Box2DSpace {
+public:
+	// Body state as of the last finished step.
+	struct BodySnapshot {
+		Transform2D transform;
+		Vector2 linear_velocity;
+		real_t angular_velocity = 0;
+		bool sleeping = false;
+	};
+
 private:
 	RID self;
 
+	// declared before the world, so it outlives it
+	Box2DSpaceAllocator allocator;
 	b2World *world = nullptr;
 
 	SelfList<Box2DBody>::List active_list;
 	SelfList<Box2DBody>::List state_query_list;
+	// objects with queued fixture changes, applied by the server before the next step and before queries
+	SelfList<Box2DCollisionObject>::List pending_update_list;
+
+	// Area monitor events are recorded while stepping and reported in call_queries,
+	// so that the step itself never calls into Godot and can run on any thread.
+	struct AreaMonitorEvent {
+		Box2DArea *area = nullptr;
+		Box2DCollisionObject *other = nullptr;
+		RID other_rid;
+		ObjectID other_instance_id;
+		int32_t other_shape_idx = -1;
+		int32_t self_shape_idx = -1;
+		PhysicsServer2D::AreaBodyStatus status = PhysicsServer2D::AREA_BODY_ADDED;
+		bool other_is_area = false;
+	};
+	LocalVector<AreaMonitorEvent> area_monitor_events;
+
+	// Every body in the space has a slot in these arrays, so the per step work sweeps contiguous memory
+	// instead of chasing each Box2DBody. Slots are removed by swapping in the last one.
+	LocalVector<Box2DBody *> slot_bodies;
+	LocalVector<b2Body *> slot_b2bodies;
+	LocalVector<uint8_t> slot_active;
+	LocalVector<real_t> slot_gravity_scale;
+	LocalVector<b2Vec2> slot_total_gravity;
+	LocalVector<b2Vec2> slot_constant_force;
+	LocalVector<b2Vec2> slot_constant_force_position;
+	LocalVector<real_t> slot_constant_torque;
+
+	// Body state is published into the back buffer after each step and the buffers are flipped,
+	// so the front one can be read without locks while the next step runs.
+	LocalVector<BodySnapshot> snapshots[2];
+	SafeNumeric<uint32_t> snapshot_front;
+
+	// Body slots can be re-sorted periodically by the Morton code of the body position, so bodies near each other
+	// are also near each other in the slot arrays. Disabled with an interval of 0.
+	int32 compaction_interval = 0;
+	int last_compaction_step = 0;
+	uint64_t compaction_moved_count = 0;
+
+	template <class T>
+	static void _permute_slots(LocalVector<T> &r_array, const LocalVector<uint32_t> &p_order);
+	void _compact_body_slots();
+
+	void _apply_body_forces();
+	void _write_body_snapshot(const Box2DBody *p_body, BodySnapshot &r_snapshot) const;
+	void _publish_body_snapshots();
+
 	struct ProcessInfo {
 		int active_body_count = 0;
 	};
 	ProcessInfo process_info;
 	bool locked = false;
-	double solver_iterations = 8;
+	int32 solver_iterations = 8;
+	int32 substeps = 1;
 
 	Box2DDirectSpaceState *direct_state = nullptr;
 	Box2DSpaceContactFilter *contact_filter;
 	Box2DSpaceContactListener *contact_listener;
 	int step_count = 0; // used for caching
+	// Bumped by each step and whenever a touching contact is destroyed, contact caches compare against it.
+	uint64_t contacts_version = 0;
+	mutable LocalVector<Vector2> contact_positions;
+	mutable uint64_t contact_positions_version = UINT64_MAX;
+	// Box2D allocations made by the last step. Once bodies and contacts stop changing it should
+	// stay at zero, the block and stack allocators reuse their memory.
+	uint64_t last_step_alloc_count = 0;
+#ifdef DEBUG_ENABLED
+	int32 last_body_count = -1;
+	int32 last_contact_count = -1;
+#endif
+
+	void _update_contact_positions() const;
 public:
 	/* PHYSICS SERVER API */
 	int32_t get_active_body_count();
@@ -51,10 +128,22 @@ public:
 	void set_solver_iterations(int32 iterations);
 	int32 get_solver_iterations() const;
 
+	void set_substeps(int32 p_substeps);
+	int32 get_substeps() const;
+
+	void set_compaction_interval(int32 p_interval);
+	int32 get_compaction_interval() const;
+	uint64_t get_compaction_moved_count() const { return compaction_moved_count; }
+	// Runs a compaction if one is due. Must not run while the space steps or its snapshot is read.
+	void compact_if_due();
+
 	void step(float p_step);
 
+	void apply_area_memberships();
 	void call_queries();
 
+	void add_area_monitor_event(Box2DArea *p_area, Box2DCollisionObject *p_other, PhysicsServer2D::AreaBodyStatus p_status, int32_t p_other_shape_idx, int32_t p_self_shape_idx);
+
 	Box2DDirectSpaceState *get_direct_state();
 	/* BODY API */
 	const SelfList<Box2DBody>::List &get_active_body_list() const;
@@ -63,6 +152,17 @@ public:
 
 	void body_add_to_state_query_list(SelfList<Box2DBody> *p_body);
 	void body_remove_from_state_query_list(SelfList<Box2DBody> *p_body);
+
+	void object_add_to_pending_update_list(SelfList<Box2DCollisionObject> *p_object);
+	void object_remove_from_pending_update_list(SelfList<Box2DCollisionObject> *p_object);
+	void flush_pending_updates();
+
+	int32_t body_add_slot(Box2DBody *p_body);
+	void body_remove_slot(int32_t p_index);
+	void body_set_slot_active(int32_t p_index, bool p_active);
+	void body_set_slot_forces(int32_t p_index, real_t p_gravity_scale, const b2Vec2 &p_total_gravity, const b2Vec2 &p_constant_force, const b2Vec2 &p_constant_force_position, real_t p_constant_torque);
+	void body_update_snapshot(int32_t p_index);
+	_FORCE_INLINE_ const BodySnapshot &get_body_snapshot(int32_t p_index) const { return snapshots[snapshot_front.get()][p_index]; }
 	/* COLLISION OBJECT API */
 	void add_object(Box2DCollisionObject *p_object);
 	void remove_object(Box2DCollisionObject *p_object);
@@ -71,6 +171,9 @@ public:
 	void remove_joint(Box2DJoint *joint);
 	/* BOX2D API */
 	b2World *get_b2World() const { return world; }
+	// Box2D allocates from the current allocator, use a Box2DSpaceAllocator::Scope around calls into the world.
+	Box2DSpaceAllocator *get_allocator() { return &allocator; }
+	Dictionary get_memory_statistics() const;
 
 	/* DIRECT BODY STATE API */
 	double get_step();
@@ -78,6 +181,9 @@ public:
 	_FORCE_INLINE_ void set_self(const RID &p_self) { self = p_self; }
 	_FORCE_INLINE_ RID get_self() const { return self; }
 
+	_FORCE_INLINE_ uint64_t get_contacts_version() const { return contacts_version; }
+	_FORCE_INLINE_ void contacts_changed() { contacts_version++; }
+
 	bool is_locked() const { return locked; }
 	void lock() { locked = true; }
 	void unlock() { locked = false; }
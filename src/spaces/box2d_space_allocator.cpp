@@ -0,0 +1,156 @@
+#include "box2d_space_allocator.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/memory.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// smallest shift with 1 << shift >= p_value, for 1 < p_value <= 2^31
+static _FORCE_INLINE_ uint32_t _ceil_log2(uint32_t p_value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, p_value - 1);
+	return index + 1;
+#else
+	return 32 - __builtin_clz(p_value - 1);
+#endif
+}
+
+thread_local Box2DSpaceAllocator *Box2DSpaceAllocator::current = nullptr;
+
+void *Box2DSpaceAllocator::_alloc_block(int32_t p_size_class) {
+	FreeBlock *free_block = free_lists[p_size_class];
+	if (free_block) {
+		free_lists[p_size_class] = free_block->next;
+		return free_block;
+	}
+	size_t block_size = size_t(1) << (p_size_class + MIN_BLOCK_SHIFT);
+	if (page_cursor + block_size > page_end) {
+		// the rest of the page is too small, start a new one
+		uint8_t *page = (uint8_t *)memalloc(PAGE_SIZE);
+		ERR_FAIL_COND_V(!page, nullptr);
+		pages.push_back(page);
+		bytes_reserved += PAGE_SIZE;
+		page_cursor = page;
+		page_end = page + PAGE_SIZE;
+	}
+	void *block = page_cursor;
+	page_cursor += block_size;
+	return block;
+}
+
+void *Box2DSpaceAllocator::_alloc_large(size_t p_size) {
+	size_t block_size = sizeof(LargeLink) + sizeof(Header) + p_size;
+	LargeLink *link = (LargeLink *)memalloc(block_size);
+	ERR_FAIL_COND_V(!link, nullptr);
+	link->prev = nullptr;
+	link->next = large_blocks;
+	if (large_blocks) {
+		large_blocks->prev = link;
+	}
+	large_blocks = link;
+	bytes_reserved += block_size;
+	return link + 1;
+}
+
+void *Box2DSpaceAllocator::alloc(size_t p_size) {
+	size_t needed = sizeof(Header) + p_size;
+	int32_t size_class = -1;
+	if (needed <= (size_t(1) << MAX_BLOCK_SHIFT)) {
+		uint32_t shift = MAX(_ceil_log2(needed), MIN_BLOCK_SHIFT);
+		// Only the header pushes a power of two request, like the 16 KiB chunks of b2BlockAllocator,
+		// into the next class. Half the block would go unused, so give larger ones a block of their own.
+		if (shift <= MIN_LARGE_ROUNDING_SHIFT || p_size > (size_t(1) << (shift - 1))) {
+			size_class = shift - MIN_BLOCK_SHIFT;
+		}
+	}
+	Header *header = (Header *)(size_class >= 0 ? _alloc_block(size_class) : _alloc_large(p_size));
+	ERR_FAIL_COND_V(!header, nullptr);
+	header->allocator = this;
+	header->size = p_size;
+	header->size_class = size_class;
+
+	bytes_in_use += p_size;
+	peak_bytes_in_use = MAX(peak_bytes_in_use, bytes_in_use);
+	alloc_count++;
+	total_alloc_count++;
+	return header + 1;
+}
+
+void Box2DSpaceAllocator::free(void *p_mem) {
+	Header *header = (Header *)p_mem - 1;
+	bytes_in_use -= header->size;
+	alloc_count--;
+	if (header->size_class >= 0) {
+		FreeBlock *free_block = (FreeBlock *)header;
+		free_block->next = free_lists[header->size_class];
+		free_lists[header->size_class] = free_block;
+	} else {
+		LargeLink *link = (LargeLink *)header - 1;
+		if (link->prev) {
+			link->prev->next = link->next;
+		} else {
+			large_blocks = link->next;
+		}
+		if (link->next) {
+			link->next->prev = link->prev;
+		}
+		bytes_reserved -= sizeof(LargeLink) + sizeof(Header) + header->size;
+		memfree(link);
+	}
+}
+
+void *Box2DSpaceAllocator::alloc_current(size_t p_size) {
+	if (current) {
+		return current->alloc(p_size);
+	}
+	Header *header = (Header *)memalloc(sizeof(Header) + p_size);
+	ERR_FAIL_COND_V(!header, nullptr);
+	header->allocator = nullptr;
+	header->size = p_size;
+	header->size_class = -1;
+	return header + 1;
+}
+
+void Box2DSpaceAllocator::free_any(void *p_mem) {
+	if (!p_mem) {
+		return;
+	}
+	Header *header = (Header *)p_mem - 1;
+	if (header->allocator) {
+		header->allocator->free(p_mem);
+	} else {
+		memfree(header);
+	}
+}
+
+Dictionary Box2DSpaceAllocator::get_statistics() const {
+	Dictionary statistics;
+	statistics["bytes_in_use"] = (int64_t)bytes_in_use;
+	statistics["peak_bytes_in_use"] = (int64_t)peak_bytes_in_use;
+	statistics["bytes_reserved"] = (int64_t)bytes_reserved;
+	statistics["alloc_count"] = (int64_t)alloc_count;
+	statistics["total_alloc_count"] = (int64_t)total_alloc_count;
+	return statistics;
+}
+
+Box2DSpaceAllocator::~Box2DSpaceAllocator() {
+	for (uint8_t *page : pages) {
+		memfree(page);
+	}
+	while (large_blocks) {
+		LargeLink *next = large_blocks->next;
+		memfree(large_blocks);
+		large_blocks = next;
+	}
+}
+
+void *box2d_alloc(int32_t p_size) {
+	return Box2DSpaceAllocator::alloc_current(p_size);
+}
+
+void box2d_free(void *p_mem) {
+	Box2DSpaceAllocator::free_any(p_mem);
+}
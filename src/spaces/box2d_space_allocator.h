@@ -0,0 +1,84 @@
+#pragma once
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace godot;
+
+// Memory behind b2Alloc/b2Free for the b2World of one space.
+// Blocks are rounded up to a power of two and carved from large pages, freed blocks go to a free list per size
+// and are reused. Blocks too large for a page are allocated on their own. Everything is released at once when
+// the allocator is destroyed.
+// Every block starts with a header naming its allocator, so b2Free finds the right one no matter which space is current.
+// Box2D calls outside any Scope allocate from the global heap and aren't in the statistics. Calls into a world that
+// can allocate (stepping, creating and destroying bodies, fixtures and joints, moving bodies, changing their type)
+// set the scope of their space.
+class Box2DSpaceAllocator {
+	static constexpr uint32_t MIN_BLOCK_SHIFT = 5; // 32 bytes
+	static constexpr uint32_t MAX_BLOCK_SHIFT = 17; // 128 KiB
+	static constexpr uint32_t SIZE_CLASS_COUNT = MAX_BLOCK_SHIFT - MIN_BLOCK_SHIFT + 1;
+	static constexpr uint32_t PAGE_SIZE = 1 << 19; // 512 KiB
+	// up to blocks of this size, rounding up a request that fits the class below for its header is accepted
+	static constexpr uint32_t MIN_LARGE_ROUNDING_SHIFT = 10; // 1 KiB
+
+	struct alignas(16) Header {
+		Box2DSpaceAllocator *allocator = nullptr;
+		uint32_t size = 0;
+		int32_t size_class = -1; // -1 for large blocks
+	};
+	// placed in front of the header of large blocks
+	struct LargeLink {
+		LargeLink *prev = nullptr;
+		LargeLink *next = nullptr;
+	};
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	LocalVector<uint8_t *> pages;
+	uint8_t *page_cursor = nullptr;
+	uint8_t *page_end = nullptr;
+	FreeBlock *free_lists[SIZE_CLASS_COUNT] = {};
+	LargeLink *large_blocks = nullptr;
+
+	uint64_t bytes_in_use = 0;
+	uint64_t peak_bytes_in_use = 0;
+	uint64_t bytes_reserved = 0;
+	uint64_t alloc_count = 0;
+	uint64_t total_alloc_count = 0;
+
+	static thread_local Box2DSpaceAllocator *current;
+
+	void *_alloc_block(int32_t p_size_class);
+	void *_alloc_large(size_t p_size);
+
+public:
+	// Makes allocations by Box2D on this thread go to p_allocator while in scope.
+	class Scope {
+		Box2DSpaceAllocator *previous;
+
+	public:
+		Scope(Box2DSpaceAllocator *p_allocator) {
+			previous = current;
+			current = p_allocator;
+		}
+		~Scope() { current = previous; }
+	};
+
+	// Allocates from the current allocator, or from the global heap outside any scope.
+	static void *alloc_current(size_t p_size);
+	static void free_any(void *p_mem);
+
+	void *alloc(size_t p_size);
+	void free(void *p_mem);
+
+	uint64_t get_bytes_in_use() const { return bytes_in_use; }
+	uint64_t get_alloc_count() const { return alloc_count; }
+	uint64_t get_total_alloc_count() const { return total_alloc_count; }
+	Dictionary get_statistics() const;
+
+	~Box2DSpaceAllocator();
+};
@@ -7,11 +7,18 @@
 
 bool Box2DSpaceContactFilter::ShouldCollide(b2Fixture *fixtureA, b2Fixture *fixtureB) {
 	Box2DCollisionObject *bodyA = fixtureA->GetBody()->GetUserData().collision_object;
-	Box2DCollisionObject *bodyB = fixtureA->GetBody()->GetUserData().collision_object;
+	Box2DCollisionObject *bodyB = fixtureB->GetBody()->GetUserData().collision_object;
 
 	const b2Filter &filterA = fixtureA->GetFilterData();
 	const b2Filter &filterB = fixtureB->GetFilterData();
 
 	bool collide = (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
-	return collide && !bodyA->is_body_collision_excepted(bodyB);
+	if (!collide) {
+		return false;
+	}
+	// most bodies have no exceptions, skip the hash lookups for them
+	if (bodyA->has_collision_exceptions() && bodyA->is_body_collision_excepted(bodyB)) {
+		return false;
+	}
+	return !bodyB->has_collision_exceptions() || !bodyB->is_body_collision_excepted(bodyA);
 }
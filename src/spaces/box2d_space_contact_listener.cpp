@@ -4,22 +4,24 @@
 
 #include "../bodies/box2d_area.h"
 #include "../bodies/box2d_collision_object.h"
+#include "box2d_space.h"
 #include "box2d/b2_contact.h"
 #include <box2d/b2_shape.h>
 
 void Box2DSpaceContactListener::handle_contact(b2Contact *contact, PhysicsServer2D::AreaBodyStatus status) {
+	// Only areas report contacts and their fixtures are sensors, so solid contacts stop here
+	// without touching the bodies.
+	if (!contact->GetFixtureA()->IsSensor() && !contact->GetFixtureB()->IsSensor()) {
+		return;
+	}
 	Box2DCollisionObject *bodyA = contact->GetFixtureA()->GetBody()->GetUserData().collision_object;
 	Box2DCollisionObject *bodyB = contact->GetFixtureB()->GetBody()->GetUserData().collision_object;
 	int shapeA = contact->GetFixtureA()->GetUserData().shape_idx;
-	int shapeB = contact->GetFixtureA()->GetUserData().shape_idx;
+	int shapeB = contact->GetFixtureB()->GetUserData().shape_idx;
 	if (bodyA->get_type() == Box2DCollisionObject::Type::TYPE_AREA) {
-		if (bodyB->get_type() == Box2DCollisionObject::Type::TYPE_AREA) {
-			((Box2DArea *)bodyA)->call_area_monitor(((Box2DArea *)bodyB), status, bodyB->get_self(), bodyB->get_object_instance_id(), shapeB, shapeA);
-		} else {
-			((Box2DArea *)bodyA)->call_monitor(bodyB, status, bodyB->get_self(), bodyB->get_object_instance_id(), shapeB, shapeA);
-		}
+		space->add_area_monitor_event((Box2DArea *)bodyA, bodyB, status, shapeB, shapeA);
 	} else if (bodyB->get_type() == Box2DCollisionObject::Type::TYPE_AREA) {
-		((Box2DArea *)bodyB)->call_monitor(bodyA, status, bodyA->get_self(), bodyA->get_object_instance_id(), shapeA, shapeB);
+		space->add_area_monitor_event((Box2DArea *)bodyB, bodyA, status, shapeA, shapeB);
 	}
 }
 
@@ -28,6 +30,8 @@ void Box2DSpaceContactListener::BeginContact(b2Contact *contact) {
 }
 
 void Box2DSpaceContactListener::EndContact(b2Contact *contact) {
+	// also called when a touching contact is destroyed outside the step, cached contact pointers go stale
+	space->contacts_changed();
 	handle_contact(contact, PhysicsServer2D::AreaBodyStatus::AREA_BODY_REMOVED);
 }
 